@@ -1,3 +1,13 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <clang/Tooling/Tooling.h>
+#include <range/v3/action/push_back.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/tooling.hpp"
 #include "get_me_benchmarks.hpp"
 
 // NOLINTNEXTLINE
@@ -40,3 +50,66 @@ GENERATE_BENCHMARKS(std_string, "#include <string>", "std::string");
 GENERATE_BENCHMARKS(std_stop_source, "#include <thread>", "std::stop_source");
 // NOLINTNEXTLINE
 GENERATE_BENCHMARKS(std_ostream, "#include <ostream>", "std::ostream");
+
+namespace {
+// NOLINTNEXTLINE(cert-err58-cpp)
+const auto BodyHeavyCode = std::string{R"(
+#include <algorithm>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+struct Config {
+  std::map<std::string, std::string> Values;
+};
+
+struct Parser {
+  explicit Parser(std::string Text) : Text_(std::move(Text)) {}
+
+  Config parse() const {
+    auto Result = Config{};
+    const auto Line = std::regex{R"re((\w+)\s*=\s*(\w+))re"};
+    for (auto Iter = std::sregex_iterator{Text_.begin(), Text_.end(), Line};
+         Iter != std::sregex_iterator{}; ++Iter) {
+      Result.Values[(*Iter)[1].str()] = (*Iter)[2].str();
+    }
+    return Result;
+  }
+
+private:
+  std::string Text_;
+};
+
+std::vector<std::string> getKeys(const Config &Conf) {
+  auto Keys = std::vector<std::string>{};
+  std::transform(Conf.Values.begin(), Conf.Values.end(),
+                 std::back_inserter(Keys),
+                 [](const auto &Entry) { return Entry.first; });
+  std::sort(Keys.begin(), Keys.end());
+  return Keys;
+}
+)"};
+
+void collectTransitionsWithBodies(benchmark::State &State) {
+  const auto Conf = std::make_shared<Config>(
+      Config{.EnableSkipFunctionBodies = State.range(0) != 0});
+  auto Args = std::vector<std::string>{"-std=c++20"};
+  ranges::push_back(Args, getParseArguments(*Conf));
+  for (auto _ : State) {
+    const auto Ast =
+        clang::tooling::buildASTFromCodeWithArgs(BodyHeavyCode, Args);
+    const auto Transitions = collectTransitions(*Ast, Conf);
+    benchmark::DoNotOptimize(Transitions->Data.begin());
+    benchmark::ClobberMemory();
+  }
+}
+} // namespace
+
+// parses and collects inside of the loop, to compare full parsing against
+// skipping function bodies
+// NOLINTNEXTLINE
+BENCHMARK(collectTransitionsWithBodies)
+    ->ArgName("skip_function_bodies")
+    ->Arg(0)
+    ->Arg(1);
@@ -9,6 +9,7 @@
 #include <clang/Tooling/Tooling.h>
 
 #include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
 #include "get_me/graph.hpp"
 #include "get_me/query.hpp"
 #include "get_me/tooling.hpp"
@@ -22,7 +23,16 @@ inline void setupCounters(benchmark::State &State, clang::ASTUnit &Ast,
   const auto Query = getQueriedTypesForInput(*Transitions, QueriedTypeAsString);
   auto Data = runGraphBuilding(Transitions, Query, Conf);
   State.counters["vertices"] = static_cast<double>(Data.VertexData.size());
-  State.counters["edges"] = static_cast<double>(Data.Edges.size());
+  // parallel edges are bundled into one edge (see GraphData::Edges)
+  State.counters["bundled_edges"] = static_cast<double>(Data.Edges.size());
+
+  const auto PrunedData = runGraphBuilding(
+      Transitions, Query,
+      std::make_shared<Config>(Config{.EnableDominancePruning = true}));
+  State.counters["vertices_dominance_pruned"] =
+      static_cast<double>(PrunedData.VertexData.size());
+  State.counters["bundled_edges_dominance_pruned"] =
+      static_cast<double>(PrunedData.Edges.size());
 }
 
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
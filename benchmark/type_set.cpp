@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/container/flat_set.hpp>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/Tooling.h>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/cartesian_product.hpp>
+#include <range/v3/view/set_algorithm.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/tooling.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me/type_id_set.hpp"
+#include "get_me/type_set.hpp"
+#include "support/testcase_generation.hpp"
+
+namespace {
+// the previous representation of TypeIdSet, for comparison
+using FlatTypeIdSet = boost::container::flat_set<TypeId>;
+
+// the vertices of the graph built for a generated test case, and for every
+// transition the conversions of its acquired type and its required types
+template <typename SetType> struct TypeSetWorkload {
+  std::vector<SetType> Vertices;
+  std::vector<std::pair<SetType, SetType>> Transitions;
+};
+
+template <typename SetType>
+[[nodiscard]] SetType convert(const TypeIdSet &Val) {
+  return Val | ranges::to<SetType>;
+}
+
+template <typename SetType, typename Generator>
+[[nodiscard]] TypeSetWorkload<SetType>
+getWorkload(const Generator &Generate, const size_t NumRepetitions) {
+  const auto [QueriedType, Code] = Generate(NumRepetitions);
+  const auto Conf = std::make_shared<Config>();
+  const std::unique_ptr<clang::ASTUnit> Ast =
+      clang::tooling::buildASTFromCodeWithArgs(Code, {"-std=c++20"});
+  const auto Transitions = collectTransitions(*Ast, Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+
+  return {Data.VertexData | ranges::views::transform([&Transitions](
+                                                        const TypeSet &Vertex) {
+            return convert<SetType>(Transitions->getTypeIds(Vertex));
+          }) | ranges::to_vector,
+          Transitions->InternedData |
+              ranges::views::transform(
+                  [&Transitions](const InternedTransitionType &Transition) {
+                    return std::pair{
+                        convert<SetType>(
+                            Transitions
+                                ->InternedConversions[ToAcquired(Transition)]),
+                        convert<SetType>(ToRequired(Transition))};
+                  }) |
+              ranges::to_vector};
+}
+
+// the target vertex of taking a transition: (vertex \ conversions) u required
+[[nodiscard]] FlatTypeIdSet applyTransition(const FlatTypeIdSet &Vertex,
+                                            const FlatTypeIdSet &Conversions,
+                                            const FlatTypeIdSet &Required) {
+  return Vertex | ranges::views::set_difference(Conversions) |
+         ranges::views::set_union(Required) | ranges::to<FlatTypeIdSet>;
+}
+
+[[nodiscard]] TypeIdSet applyTransition(const TypeIdSet &Vertex,
+                                        const TypeIdSet &Conversions,
+                                        const TypeIdSet &Required) {
+  return setDifferenceAndUnion(Vertex, Conversions, Required);
+}
+
+[[nodiscard]] bool isSubsetOf(const FlatTypeIdSet &Subset,
+                              const FlatTypeIdSet &Superset) {
+  return std::includes(Superset.begin(), Superset.end(), Subset.begin(),
+                       Subset.end());
+}
+
+[[nodiscard]] bool isSubsetOf(const TypeIdSet &Subset,
+                              const TypeIdSet &Superset) {
+  return isSubset(Subset, Superset);
+}
+
+template <typename SetType, typename Generator>
+void typeSetAlgebra(benchmark::State &State, const Generator &Generate) {
+  const auto Workload =
+      getWorkload<SetType>(Generate, static_cast<size_t>(State.range(0)));
+  auto Pairs = ranges::views::cartesian_product(Workload.Vertices,
+                                                Workload.Transitions);
+  for (auto _ : State) {
+    ranges::for_each(Pairs, [](const auto &Pair) {
+      const auto &[Vertex, Transition] = Pair;
+      const auto &[Conversions, Required] = Transition;
+      benchmark::DoNotOptimize(isSubsetOf(Required, Vertex));
+      benchmark::DoNotOptimize(applyTransition(Vertex, Conversions, Required));
+    });
+    benchmark::ClobberMemory();
+  }
+  State.counters["vertices"] = static_cast<double>(Workload.Vertices.size());
+  State.counters["transitions"] =
+      static_cast<double>(Workload.Transitions.size());
+  State.SetItemsProcessed(
+      State.iterations() *
+      static_cast<std::int64_t>(Workload.Vertices.size() *
+                                Workload.Transitions.size()));
+}
+} // namespace
+
+// compares the set algebra of graph building on the vertices and transitions
+// of generated test cases, using the sorted flat_set representation and the
+// bitset representation of TypeIdSet
+// NOLINTBEGIN
+BENCHMARK_CAPTURE(typeSetAlgebra<FlatTypeIdSet>, forkingPath_flat_set,
+                  GenerateForkingPath)
+    ->DenseRange(1, 10, 1);
+BENCHMARK_CAPTURE(typeSetAlgebra<TypeIdSet>, forkingPath_bitset,
+                  GenerateForkingPath)
+    ->DenseRange(1, 10, 1);
+BENCHMARK_CAPTURE(typeSetAlgebra<FlatTypeIdSet>, templatePath_flat_set,
+                  GenerateMultiForkingPath)
+    ->DenseRange(1, 10, 1);
+BENCHMARK_CAPTURE(typeSetAlgebra<TypeIdSet>, templatePath_bitset,
+                  GenerateMultiForkingPath)
+    ->DenseRange(1, 10, 1);
+// NOLINTEND
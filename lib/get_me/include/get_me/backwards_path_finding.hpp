@@ -1,8 +1,78 @@
 #ifndef get_me_lib_get_me_include_get_me_backwards_path_finding_hpp
 #define get_me_lib_get_me_include_get_me_backwards_path_finding_hpp
 
+#include <chrono>
+#include <optional>
+#include <stack>
+#include <vector>
+
 #include "get_me/graph.hpp"
+#include "support/ranges/generator.hpp"
+
+// depth-first search from the leaf vertices of the graph backwards to its root
+// vertices. Every path is produced as soon as the search reaches a root vertex
+// instead of after the whole search finished.
+class PathGenerator {
+public:
+  // stops the search at Deadline, checked before every edge it takes
+  explicit PathGenerator(const GraphData &Data,
+                         std::chrono::steady_clock::time_point Deadline =
+                             std::chrono::steady_clock::time_point::max());
+  // only searches the paths that end with Prefix, given in the order of the
+  // backwards search from a leaf vertex. Prefix does not start at a root
+  // vertex (see split).
+  PathGenerator(const GraphData &Data, PathType Prefix);
+
+  // the next path that is not a permutation of a previously produced path, or
+  // std::nullopt if there are no more paths or the deadline has passed
+  [[nodiscard]] std::optional<PathType> next();
+
+  // the prefixes one edge longer than the current path that the search takes
+  // next, in the order it takes them. The paths of a search of each of them,
+  // or the prefix itself once it starts at a root vertex, are the paths of
+  // this generator. Has to be called before next.
+  [[nodiscard]] std::vector<PathType> split();
+
+private:
+  [[nodiscard]] bool rollbackPathIfRequired(const TransitionEdgeType &Edge);
+  [[nodiscard]] bool shouldIgnore(const TransitionEdgeType &Edge) const;
+  // whether taking Edge before the last edge of the current path is not in
+  // canonical order and the search also takes the swapped path
+  [[nodiscard]] bool
+  isSkippableNonCanonicalOrder(const TransitionEdgeType &Edge) const;
+  [[nodiscard]] bool shouldSkip(const TransitionEdgeType &Edge);
+
+  const GraphData *Data_;
+  std::stack<TransitionEdgeType> EdgesStack_;
+  PathType CurrentPath_;
+  PathSignatureSet FoundSignatures_;
+  std::chrono::steady_clock::time_point Deadline_{
+      std::chrono::steady_clock::time_point::max()};
+};
+
+// the edges into leaf vertices that the backwards search starts from
+[[nodiscard]] std::vector<TransitionEdgeType>
+getStartEdges(const GraphData &Data);
+
+// lazy range of the paths of PathGenerator, ends early at Deadline
+[[nodiscard]] inline auto
+generatePaths(const GraphData &Data,
+              const std::chrono::steady_clock::time_point Deadline =
+                  std::chrono::steady_clock::time_point::max()) {
+  return toLazyRange(PathGenerator{Data, Deadline});
+}
+
+// the prefixes of the backwards search that are searched independently,
+// ordered like the sequential search. Prefixes are extended by an edge until
+// there are at least MinNumPrefixes of them or all of them start at a root
+// vertex.
+[[nodiscard]] std::vector<PathType> splitPathSearch(const GraphData &Data,
+                                                    size_t MinNumPrefixes);
 
-[[nodiscard]] PathContainer runPathFinding(GraphData &Data);
+// all paths of the graph, searched in parallel over the prefixes of
+// splitPathSearch if Config::EnableParallelPathFinding is set, so that a deep
+// subtree below a single start edge is searched by several tasks. The result
+// does not depend on the option.
+[[nodiscard]] PathContainer runPathFinding(const GraphData &Data);
 
 #endif
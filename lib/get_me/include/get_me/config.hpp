@@ -43,12 +43,27 @@ public:
                                &Config::EnableGraphBackwardsEdge},
             BooleanMappingType{"EnableVerboseTransitionCollection",
                                &Config::EnableVerboseTransitionCollection},
+            BooleanMappingType{"EnableSkipFunctionBodies",
+                               &Config::EnableSkipFunctionBodies},
+            BooleanMappingType{"EnableParallelGraphBuilding",
+                               &Config::EnableParallelGraphBuilding},
+            BooleanMappingType{"EnablePathOrderReduction",
+                               &Config::EnablePathOrderReduction},
+            BooleanMappingType{"EnableParallelPathFinding",
+                               &Config::EnableParallelPathFinding},
+            BooleanMappingType{"EnableDominancePruning",
+                               &Config::EnableDominancePruning},
+            BooleanMappingType{"EnableSharedExpansionCache",
+                               &Config::EnableSharedExpansionCache},
         },
         std::array{
             SizeTMappingType{"MaxGraphDepth", &Config::MaxGraphDepth},
             SizeTMappingType{"MaxRemainingTypes", &Config::MaxRemainingTypes},
             SizeTMappingType{"MaxPathLength", &Config::MaxPathLength},
             SizeTMappingType{"MaxPathOutputCount", &Config::MaxPathOutputCount},
+            SizeTMappingType{"MaxGraphVertices", &Config::MaxGraphVertices},
+            SizeTMappingType{"MaxQueryMilliseconds",
+                             &Config::MaxQueryMilliseconds},
         }};
   }
 
@@ -65,11 +80,20 @@ public:
   bool EnableFilterStd = false;
   bool EnableGraphBackwardsEdge = true;
   bool EnableVerboseTransitionCollection = false;
+  bool EnableSkipFunctionBodies = false;
+  bool EnableParallelGraphBuilding = false;
+  bool EnablePathOrderReduction = false;
+  bool EnableParallelPathFinding = false;
+  bool EnableDominancePruning = false;
+  bool EnableSharedExpansionCache = false;
 
   std::size_t MaxGraphDepth = 4UZ;
   std::size_t MaxRemainingTypes = std::numeric_limits<std::size_t>::max();
   std::size_t MaxPathLength = 4UZ;
   std::size_t MaxPathOutputCount = 10UZ;
+  // budgets of a single query, a query that exceeds them is truncated
+  std::size_t MaxGraphVertices = std::numeric_limits<std::size_t>::max();
+  std::size_t MaxQueryMilliseconds = std::numeric_limits<std::size_t>::max();
   // NOLINTEND(misc-non-private-member-variables-in-classes,*magic-numbers)
 };
 
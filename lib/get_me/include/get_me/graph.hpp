@@ -1,32 +1,38 @@
 #ifndef get_me_lib_get_me_include_get_me_graph_hpp
 #define get_me_lib_get_me_include_get_me_graph_hpp
 
+#include <chrono>
 #include <compare>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <boost/container/flat_set.hpp>
+#include <boost/dynamic_bitset/dynamic_bitset.hpp>
+#include <boost/unordered/concurrent_flat_map.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <fmt/ranges.h> // IWYU pragma: keep
-#include <range/v3/algorithm/lexicographical_compare.hpp>
-#include <range/v3/algorithm/permutation.hpp>
 #include <range/v3/functional/bind_back.hpp>
-#include <range/v3/functional/comparisons.hpp>
 #include <range/v3/range/primitives.hpp>
 #include <range/v3/range/traits.hpp>
 #include <range/v3/view/for_each.hpp>
 #include <range/v3/view/map.hpp>
 #include <range/v3/view/transform.hpp>
 
-#include "get_me/indexed_set.hpp"
+#include "get_me/subset_index.hpp"
 #include "get_me/transitions.hpp"
+#include "get_me/type_id_set.hpp"
 #include "get_me/type_set.hpp"
+#include "support/ranges/generator.hpp"
 
 namespace clang {
 class CXXRecordDecl;
@@ -45,18 +51,14 @@ using EdgeType = std::pair<size_t, size_t>;
 struct TransitionEdgeType {
   EdgeType Edge;
   size_t TransitionIndex{};
+  // the index of the edge in GraphData::Edges, set when the parallel edges
+  // are bundled
+  size_t EdgeIndex{};
 
   [[nodiscard]] friend constexpr auto
   operator<=>(const TransitionEdgeType &, const TransitionEdgeType &) = default;
 };
 
-// FIXME: can combine multiple edges by storing all indices belonging to those
-// edges in a vector
-// this would also implement the edges as transition independent transitions
-// (saves on duplicate paths and others)
-// the problem with this would be that of rendering paths as strings (or just
-// use views::for_each)
-
 template <> class fmt::formatter<TransitionEdgeType> {
 public:
   // NOLINTBEGIN(readability-convert-member-functions-to-static)
@@ -74,24 +76,43 @@ public:
 
 using PathType = std::vector<TransitionEdgeType>;
 
-struct IsPermutationComparator {
-  [[nodiscard]] bool operator()(const PathType &Lhs,
-                                const PathType &Rhs) const {
-    if (const auto Comp = Lhs.size() <=> Rhs.size(); std::is_neq(Comp)) {
-      return std::is_lt(Comp);
-    }
+struct GraphData;
 
-    return !ranges::is_permutation(Lhs, Rhs, ranges::equal_to{},
-                                   &TransitionEdgeType::TransitionIndex,
-                                   &TransitionEdgeType::TransitionIndex) &&
-           ranges::lexicographical_compare(
-               Lhs, Rhs, ranges::less{}, &TransitionEdgeType::TransitionIndex,
-               &TransitionEdgeType::TransitionIndex);
-  }
-};
+// the transition bundles of every edge of a path (see
+// GraphData::getEdgeTransitions), in ascending order. Paths that are
+// permutations of each other have the same signature, paths with the same
+// signature take the same alternatives.
+using PathSignature = std::vector<std::vector<size_t>>;
+using PathSignatureSet = boost::unordered_flat_set<PathSignature>;
+
+[[nodiscard]] PathSignature getPathSignature(const PathType &Path,
+                                             const GraphData &Data);
 
-using PathContainer =
-    boost::container::flat_set<PathType, IsPermutationComparator>;
+// append-only storage of paths in the order they were added, without paths
+// that are permutations of a previously added path
+class PathContainer {
+public:
+  using value_type = PathType;
+  using const_iterator = std::vector<PathType>::const_iterator;
+  using iterator = const_iterator;
+  using size_type = std::size_t;
+
+  explicit PathContainer(const GraphData &Data)
+      : Data_{&Data} {}
+
+  // adds Path if no permutation of it was added before
+  bool insert(PathType Path);
+
+  [[nodiscard]] const_iterator begin() const noexcept { return Paths_.begin(); }
+  [[nodiscard]] const_iterator end() const noexcept { return Paths_.end(); }
+  [[nodiscard]] size_type size() const noexcept { return Paths_.size(); }
+  [[nodiscard]] bool empty() const noexcept { return Paths_.empty(); }
+
+private:
+  const GraphData *Data_;
+  std::vector<PathType> Paths_;
+  PathSignatureSet Signatures_;
+};
 
 struct FlatPathEdge {
   FlatPathEdge(EdgeType Edge, FlatTransitionType FlatTransition)
@@ -126,6 +147,15 @@ struct GraphData {
             EdgeContainer Edges, std::shared_ptr<TransitionData> Transitions,
             PathContainer Paths, std::shared_ptr<Config> Conf);
 
+  [[nodiscard]] std::span<const TransitionEdgeType>
+  getIncomingEdges(VertexDescriptor Vertex) const;
+
+  // the indices of the transition bundles of an edge in Edges, in ascending
+  // order. Looked up by the index the edge stores, Edge has to be taken from
+  // Edges (or IncomingEdges).
+  [[nodiscard]] std::span<const size_t>
+  getEdgeTransitions(const TransitionEdgeType &Edge) const;
+
   // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
 
   std::vector<TypeSet> VertexData;
@@ -133,8 +163,32 @@ struct GraphData {
   // depth the vertex was first visited
   std::vector<size_t> VertexDepth;
 
+  // a single edge for every pair of connected vertices, the parallel edges of
+  // the graph builder are bundled into it. The transition index of an edge is
+  // the lowest index of its transition bundles.
   EdgeContainer Edges;
 
+  // the transition bundles of Edges[I] are
+  // EdgeTransitions[EdgeTransitionOffsets[I], EdgeTransitionOffsets[I + 1]),
+  // where I is the TransitionEdgeType::EdgeIndex of the edge
+  std::vector<size_t> EdgeTransitions;
+  std::vector<size_t> EdgeTransitionOffsets;
+
+  // the edges ordered by their target, the incoming edges of vertex V are
+  // IncomingEdges[IncomingEdgeOffsets[V], IncomingEdgeOffsets[V + 1]) and
+  // ordered like in Edges
+  std::vector<TransitionEdgeType> IncomingEdges;
+  std::vector<size_t> IncomingEdgeOffsets;
+
+  // vertices without incoming edges
+  boost::dynamic_bitset<> RootVertices;
+  // vertices without outgoing edges
+  boost::dynamic_bitset<> LeafVertices;
+
+  // the strongly connected component of every vertex, vertices of different
+  // components can not be on a cycle together
+  std::vector<size_t> VertexComponents;
+
   std::shared_ptr<TransitionData> Transitions;
 
   std::shared_ptr<Config> Conf;
@@ -224,13 +278,53 @@ getRootVertices(const GraphData &Data);
 [[nodiscard]] std::vector<VertexDescriptor>
 getLeafVertices(const GraphData &Data);
 
+// the vertices that the consecutive edges First and Second (taken in this
+// order) can be swapped through if they are not in canonical order: their
+// transitions commute, i.e., the graph also contains the path that takes the
+// transition bundles of Second first to one of the returned vertices and then
+// those of First to the same vertex, and the lowest bundle of Second has the
+// lower index. Empty if the edges are in canonical order.
+// Path finding skips a non-canonical order when
+// Config::EnablePathOrderReduction is set and it also finds the swapped path,
+// i.e., the swapped path satisfies the same rules (see canSwapOrderThrough).
+[[nodiscard]] std::vector<VertexDescriptor>
+getSwappedOrderVertices(const GraphData &Data, const TransitionEdgeType &First,
+                        const TransitionEdgeType &Second);
+
+// whether swapping the consecutive edges First and Second of a path through
+// Swapped (see getSwappedOrderVertices) results in a path that path finding
+// also takes, whatever the path continues with before First and after Second.
+// Known are the other edges of the path, they may not take Swapped as their
+// source or target. Edges that are not known yet may not either, which holds
+// if Swapped is in neither the component of the source of First nor the
+// component of the target of Second.
+[[nodiscard]] bool canSwapOrderThrough(const GraphData &Data,
+                                       const PathType &Known,
+                                       const TransitionEdgeType &First,
+                                       const TransitionEdgeType &Second,
+                                       VertexDescriptor Swapped);
+
+// whether every edge of Path and Edge can take a different transition bundle
+// (see GraphData::getEdgeTransitions), a path does not use a transition twice.
+// Requires that the edges of Path can take different bundles.
+[[nodiscard]] bool canTakeDistinctTransitions(const GraphData &Data,
+                                              const PathType &Path,
+                                              const TransitionEdgeType &Edge);
+
 namespace detail {
 [[nodiscard]] inline std::string
 formatTransition(const TransitionEdgeType &Edge, const GraphData &Data) {
-  const auto Transition = Data.Transitions->BundeledData[Edge.TransitionIndex];
-  return fmt::format("({}, {}, {})", ToAcquired(Transition),
-                     ToTransitions(Transition) | ranges::views::values,
-                     ToRequired(Transition));
+  const auto FormatBundle = [&Transitions =
+                                   *Data.Transitions](const size_t Index) {
+    const auto &Transition = Transitions.InternedData[Index];
+    return fmt::format(
+        "({}, {}, {})", Transitions.Types[ToAcquired(Transition)],
+        ToTransitions(Transitions.getBundle(Index)) | ranges::views::values,
+        Transitions.getTypes(ToRequired(Transition)));
+  };
+  return fmt::format("{}", fmt::join(Data.getEdgeTransitions(Edge) |
+                                         ranges::views::transform(FormatBundle),
+                                     " | "));
 };
 
 [[nodiscard]] inline std::string formatPath(const PathType &Path,
@@ -252,6 +346,37 @@ template <typename RangeType>
 [[nodiscard]] std::vector<std::vector<FlatPathEdge>>
 expandAndFlattenPath(const PathType &Path, const GraphData &Data);
 
+// produces the flattened paths of expandAndFlattenPath one at a time and in
+// the same order, without materializing every combination of the transitions
+// bundled in the edges of the path. Combinations that take the same transition
+// on two edges are skipped, like a path does not take a bundle twice.
+class FlatPathGenerator {
+public:
+  FlatPathGenerator(const PathType &Path, const GraphData &Data);
+
+  [[nodiscard]] std::optional<std::vector<FlatPathEdge>> next();
+
+private:
+  void advance();
+  [[nodiscard]] bool takesDistinctTransitions() const;
+
+  // for every edge, the flattened transitions of all of its transition
+  // bundles
+  std::vector<std::vector<FlatPathEdge>> EdgeAlternatives_;
+  // the transition index of every alternative in EdgeAlternatives_
+  std::vector<std::vector<size_t>> EdgeAlternativeTransitions_;
+  // for every edge, the index of the alternative that is used by the next
+  // flattened path
+  std::vector<size_t> AlternativeIndices_;
+  bool Exhausted_;
+};
+
+// lazy range of the flattened paths of FlatPathGenerator
+[[nodiscard]] inline auto generateFlatPaths(const PathType &Path,
+                                            const GraphData &Data) {
+  return toLazyRange(FlatPathGenerator{Path, Data});
+}
+
 template <typename RangeType>
   requires std::same_as<ranges::range_value_t<RangeType>, PathType>
 [[nodiscard]] auto toStringExpanded(const RangeType &Paths,
@@ -264,25 +389,64 @@ template <typename RangeType>
   };
 
   return Paths |
-         ranges::views::for_each(
-             ranges::bind_back(expandAndFlattenPath, Data)) |
+         ranges::views::for_each(ranges::bind_back(generateFlatPaths, Data)) |
          ranges::views::transform(FormatPath);
 }
 
+// the transitions that acquire a type of a vertex, independent of the query.
+// Shared by the graph builders of multiple queries on the same transitions,
+// the builders only filter out the transitions that require a queried type.
+// Safe to use concurrently.
+class ExpansionCache {
+public:
+  explicit ExpansionCache(std::shared_ptr<TransitionData> Transitions);
+
+  [[nodiscard]] std::vector<InternedTransitionType>
+  getTransitionsForVertex(const TypeIdSet &Vertex);
+
+private:
+  std::shared_ptr<TransitionData> Transitions_;
+  // every transition for each type it can provide, with the acquired type
+  // replaced by that type and sorted by it
+  std::vector<InternedTransitionType> TransitionsByType_;
+  boost::concurrent_flat_map<TypeIdSet, std::vector<InternedTransitionType>,
+                             TypeIdSetHash>
+      TransitionsByVertex_;
+};
+
 class GraphBuilder {
 public:
-  using VertexType = TypeSet;
-  using VertexSet = indexed_set<VertexType>;
+  // vertices are built from interned types, GraphData::VertexData contains
+  // the types themselves
+  using VertexType = TypeIdSet;
+  using VertexSet = boost::container::flat_set<VertexDescriptor>;
 
   explicit GraphBuilder(std::shared_ptr<TransitionData> Transitions,
-                        TypeSet Query, std::shared_ptr<Config> Conf);
-
-  void build();
+                        TypeSet Query, std::shared_ptr<Config> Conf,
+                        std::shared_ptr<ExpansionCache> Cache = {});
+  // a query of all of the queried types at once: there is one root vertex for
+  // every combination of one type of each query, a path acquires all of them
+  // and resolves the types they share only once. Config::MaxGraphDepth and
+  // Config::MaxPathLength are multiplied by the number of queries, the
+  // committed GraphData holds the scaled copy of Conf.
+  explicit GraphBuilder(std::shared_ptr<TransitionData> Transitions,
+                        const std::vector<TypeSet> &Queries,
+                        std::shared_ptr<Config> Conf,
+                        std::shared_ptr<ExpansionCache> Cache = {});
+
+  // builds until Config::MaxGraphDepth or Deadline is reached, the vertices
+  // of a step are not expanded after Deadline either
+  void build(std::chrono::steady_clock::time_point Deadline =
+                 std::chrono::steady_clock::time_point::max());
   [[nodiscard]] bool buildStep();
   [[nodiscard]] bool buildStepFor(VertexDescriptor Vertex);
   [[nodiscard]] bool buildStepFor(const VertexType &InterestingVertex);
   [[nodiscard]] bool buildStepFor(VertexSet InterestingVertices);
 
+  // whether the build stopped early at its deadline or vertices were not
+  // added because of Config::MaxGraphVertices
+  [[nodiscard]] bool isTruncated() const { return Truncated_; }
+
   [[nodiscard]] GraphData commit();
 
 private:
@@ -293,26 +457,45 @@ private:
 
   class GraphBuilderImpl;
 
-  [[nodiscard]] bool
-  isEmptyTargetTS(const VertexSet::key_type::first_type VertexIndex) const {
+  using VertexIndexMap =
+      boost::unordered_flat_map<VertexType, VertexDescriptor, TypeIdSetHash>;
+
+  [[nodiscard]] bool isEmptyTargetTS(const VertexDescriptor VertexIndex) const {
     return VertexIndex == EmptyTsIndex_;
   }
 
   std::shared_ptr<TransitionData> Transitions_;
-  TypeSet Query_;
-  VertexSet::value_type::first_type EmptyTsIndex_;
-  VertexSet VertexData_;
+  // the type set of each vertex, indexed by its descriptor. The root vertices
+  // of the queries come first, followed by the empty vertex.
+  std::vector<VertexType> VertexData_;
+  VertexDescriptor EmptyTsIndex_;
+  // the descriptor of each type set, hashed with the incrementally maintained
+  // hash of the set
+  VertexIndexMap VertexIndices_;
   std::vector<size_t> VertexDepth_;
   GraphData::EdgeContainer Edges_;
   std::shared_ptr<Config> Conf_;
+  // the non-empty vertices, for Config::EnableDominancePruning
+  SubsetIndex DominatingVertices_;
 
   StepState CurrentState_{};
+  bool Truncated_{};
+  // of the last call to build, the steps before it have no deadline
+  std::chrono::steady_clock::time_point Deadline_{
+      std::chrono::steady_clock::time_point::max()};
 
   std::unique_ptr<GraphBuilderImpl> Impl_;
 };
 
 [[nodiscard]] GraphData
 runGraphBuilding(const std::shared_ptr<TransitionData> &Transitions,
-                 const TypeSet &Query, std::shared_ptr<Config> Conf);
+                 const TypeSet &Query, std::shared_ptr<Config> Conf,
+                 std::shared_ptr<ExpansionCache> Cache = {});
+
+[[nodiscard]] GraphData
+runGraphBuilding(const std::shared_ptr<TransitionData> &Transitions,
+                 const std::vector<TypeSet> &Queries,
+                 std::shared_ptr<Config> Conf,
+                 std::shared_ptr<ExpansionCache> Cache = {});
 
 #endif
@@ -57,7 +57,8 @@ struct IndexedSetComparator {
   }
 
   template <ranges::range ValueType>
-    requires std::three_way_comparable<ranges::range_value_t<ValueType>>
+    requires(!std::three_way_comparable<ValueType> &&
+             std::three_way_comparable<ranges::range_value_t<ValueType>>)
   [[nodiscard]] static constexpr bool
   operator()(const indexed_value<ValueType> &Lhs,
              const indexed_value<ValueType> &Rhs) {
@@ -75,13 +76,15 @@ struct IndexedSetComparator {
     return false;
   }
   template <ranges::range ValueType>
-    requires std::three_way_comparable<ranges::range_value_t<ValueType>>
+    requires(!std::three_way_comparable<ValueType> &&
+             std::three_way_comparable<ranges::range_value_t<ValueType>>)
   [[nodiscard]] static constexpr bool
   operator()(const indexed_value<ValueType> &Lhs, const ValueType &Rhs) {
     return Value(Lhs) < Rhs;
   }
   template <ranges::range ValueType>
-    requires std::three_way_comparable<ranges::range_value_t<ValueType>>
+    requires(!std::three_way_comparable<ValueType> &&
+             std::three_way_comparable<ranges::range_value_t<ValueType>>)
   [[nodiscard]] static constexpr bool
   operator()(const ValueType &Lhs, const indexed_value<ValueType> &Rhs) {
     return Lhs < Value(Rhs);
@@ -0,0 +1,24 @@
+#ifndef get_me_lib_get_me_include_get_me_path_statistics_hpp
+#define get_me_lib_get_me_include_get_me_path_statistics_hpp
+
+#include <cstddef>
+#include <vector>
+
+#include "get_me/graph.hpp"
+
+// the number of paths of a graph per path length, the index is the length of
+// the paths. Counts saturate at the maximum of size_t.
+struct PathStatistics {
+  // the paths runPathFinding finds
+  std::vector<std::size_t> PathCounts;
+  // the flattened paths of these paths, see expandAndFlattenPath
+  std::vector<std::size_t> ExpandedPathCounts;
+};
+
+// counts the paths up to Config::MaxPathLength by running the path search of
+// runPathFinding without storing the paths, i.e., under the same rules: no
+// vertex or transition is used twice and permutations are counted once. The
+// flattened paths are generated one at a time and only counted.
+[[nodiscard]] PathStatistics getPathStatistics(const GraphData &Data);
+
+#endif
@@ -1,8 +1,25 @@
 #ifndef get_me_lib_get_me_include_get_me_propagate_type_conversions_hpp
 #define get_me_lib_get_me_include_get_me_propagate_type_conversions_hpp
 
+#include <functional>
+
 #include "get_me/transitions.hpp"
+#include "get_me/type_set.hpp"
+
+// the operations on types that the propagated conversions are derived from
+struct TypeConversionOperations {
+  // the type a pointer points to or a reference refers to, the type itself
+  // otherwise
+  std::function<Type(const Type &)> StripPointerRef;
+  // the type without its top-level const qualifier
+  std::function<Type(const Type &)> RemoveLocalConst;
+};
+
+// the operations on clang::QualTypes, other types are left unchanged
+[[nodiscard]] TypeConversionOperations getQualTypeConversionOperations();
 
-void propagateTypeConversions(TransitionData &Transitions);
+void propagateTypeConversions(TransitionData &Transitions,
+                              const TypeConversionOperations &Operations =
+                                  getQualTypeConversionOperations());
 
 #endif
@@ -1,17 +1,47 @@
 #ifndef get_me_lib_get_me_include_get_me_query_hpp
 #define get_me_lib_get_me_include_get_me_query_hpp
 
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "get_me/transitions.hpp"
 #include "get_me/type_set.hpp"
 
-[[nodiscard]] TransitionData::associative_container_type getTransitionsForQuery(
-    const TransitionData::associative_container_type &Transitions,
-    const TypeSet &Query);
+// the transitions that may be taken for a query of several types (see
+// GraphBuilder). A transition is dropped if it requires a type of the same
+// query as a type it provides: acquiring that type would require itself. A
+// transition that provides none of the queried types is dropped if it
+// requires a type of every query, it is of no use for a path that acquires
+// them.
+// With a single query, every transition that requires a queried type is
+// dropped. An empty list of queries keeps every transition.
+[[nodiscard]] std::vector<InternedTransitionType>
+getTransitionsForQuery(const TransitionData &Data,
+                       const std::vector<InternedTransitionType> &Transitions,
+                       const std::vector<TypeIdSet> &Queries);
 
 [[nodiscard]] TypeSet
 getQueriedTypesForInput(const TransitionData &Transitions,
                         std::string_view QueriedTypeAsString);
 
+// splits a list of type names at the commas that are not nested in template
+// arguments, parentheses or brackets, e.g., "std::pair<int, float>, A" into
+// "std::pair<int, float>" and "A". The names are trimmed, empty names are
+// dropped.
+[[nodiscard]] std::vector<std::string>
+splitTypeNames(std::string_view TypeNames);
+
+// the queries of several type names, one query per name, for a query of all
+// of the types at once (see GraphBuilder)
+[[nodiscard]] std::vector<TypeSet>
+getQueriedTypesForInputs(const TransitionData &Transitions,
+                         const std::vector<std::string> &QueriedTypeNames);
+
+// the query of QueriedType, like getQueriedTypesForInput but resolves the type
+// itself instead of its name, requires TransitionData::commit
+[[nodiscard]] TypeSet
+getQueriedTypesForType(const TransitionData &Transitions,
+                       const TransparentType &QueriedType);
+
 #endif
@@ -1,12 +1,69 @@
 #ifndef get_me_lib_query_all_include_query_all_hpp
 #define get_me_lib_query_all_include_query_all_hpp
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query_report.hpp"
 #include "get_me/transitions.hpp"
+#include "get_me/type_set.hpp"
 
+// the distinct queries of the acquired types of all transitions, resolved by
+// the types themselves
+[[nodiscard]] std::vector<TypeSet>
+getAllQueries(const TransitionData &Transitions);
+
+// a cheap estimate of the cost of each query: the number of transitions that
+// can provide a type of the query, i.e., the fan-in of its root vertex summed
+// over its conversions
+[[nodiscard]] std::vector<std::size_t>
+estimateQueryCosts(const TransitionData &Transitions,
+                   const std::vector<TypeSet> &Queries);
+
+// the queries of getAllQueries, ordered by their estimated cost from the most
+// to the least expensive
+[[nodiscard]] std::vector<TypeSet>
+getScheduledQueries(const TransitionData &Transitions);
+
+// the phases runQuery runs after building the graph
+struct QueryOptions {
+  // counts the paths runPathFinding finds into QueryReport::PathCount, which
+  // stays 0 otherwise. Every path is generated to count it, without keeping
+  // the paths.
+  bool CountPaths = true;
+  // ranks and formats the best paths into QueryReport::Paths
+  bool RankPaths = true;
+};
+
+// builds the graph of Query and searches its paths, with the timings of each
+// phase. Stops at Config::MaxGraphVertices and after
+// Config::MaxQueryMilliseconds, which is checked per step of the graph
+// building, of the path search that counts the paths and of the ranking. The
+// report is marked as truncated then.
+[[nodiscard]] QueryReport
+runQuery(const std::shared_ptr<TransitionData> &Transitions,
+         const TypeSet &Query, std::shared_ptr<Config> Conf,
+         std::shared_ptr<ExpansionCache> Cache = {},
+         QueryOptions Options = {});
+
+// runQuery for several types at once, see GraphBuilder
+[[nodiscard]] QueryReport
+runQuery(const std::shared_ptr<TransitionData> &Transitions,
+         const std::vector<TypeSet> &Queries, std::shared_ptr<Config> Conf,
+         std::shared_ptr<ExpansionCache> Cache = {},
+         QueryOptions Options = {});
+
+// runs a query for every distinct query of getAllQueries, sharing an
+// ExpansionCache between the queries if Config::EnableSharedExpansionCache is
+// set. The most expensive queries are started first (see getScheduledQueries),
+// so that they do not run alone at the end. The report of each query is
+// written to Writer if there is one, without a Writer the paths are only
+// counted and not ranked.
 void queryAll(const std::shared_ptr<TransitionData> &Transitions,
-              std::shared_ptr<Config> Conf);
+              std::shared_ptr<Config> Conf,
+              QueryReportWriter *Writer = nullptr);
 
 #endif
@@ -0,0 +1,71 @@
+#ifndef get_me_lib_get_me_include_get_me_query_report_hpp
+#define get_me_lib_get_me_include_get_me_query_report_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
+// the result of a single query of queryAll
+struct QueryReport {
+  // the names of the queried types
+  std::vector<std::string> Query;
+  // the best Config::MaxPathOutputCount paths (see runTopKPathFinding),
+  // formatted like formatPaths
+  std::vector<std::string> Paths;
+  // the number of paths runPathFinding finds
+  std::size_t PathCount{};
+  std::size_t VertexCount{};
+  // parallel edges are bundled into one edge (see GraphData::Edges)
+  std::size_t EdgeCount{};
+  // whether the query exceeded its budget (Config::MaxGraphVertices or
+  // Config::MaxQueryMilliseconds), the counts and paths are incomplete
+  bool Truncated{};
+  std::chrono::microseconds GraphBuildingTime{};
+  std::chrono::microseconds PathFindingTime{};
+  std::chrono::microseconds RankingTime{};
+};
+
+enum class QueryReportFormat {
+  // one JSON object per line and report
+  JsonLines,
+  // a header followed by one length-prefixed record per report, see
+  // toBinaryRecord
+  Binary,
+};
+
+// a single line of JSON, without the trailing newline
+[[nodiscard]] std::string toJsonLine(const QueryReport &Report);
+
+// the record of Report in the binary format. All integers are 64-bit little
+// endian: the size of the rest of the record, path count, vertex count, edge
+// count, truncated (0 or 1), the timings in microseconds (graph building, path
+// finding, ranking), the queried types and the paths. Strings and lists are
+// prefixed with their size.
+[[nodiscard]] std::string toBinaryRecord(const QueryReport &Report);
+
+// streams reports to Stream as soon as they are written, the writer keeps no
+// report in memory. write may be called concurrently, a report is serialized
+// before the stream is locked.
+class QueryReportWriter {
+public:
+  QueryReportWriter(llvm::raw_ostream &Stream, QueryReportFormat Format);
+
+  void write(const QueryReport &Report);
+
+  // the number of written reports
+  [[nodiscard]] std::size_t size() const;
+
+private:
+  llvm::raw_ostream *Stream_;
+  QueryReportFormat Format_;
+  mutable std::mutex Mutex_;
+  std::size_t NumWrittenReports_{};
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef get_me_lib_get_me_include_get_me_ranked_path_finding_hpp
+#define get_me_lib_get_me_include_get_me_ranked_path_finding_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "get_me/graph.hpp"
+
+// finds the MaxPathCount best paths of the graph, ordered by their length and
+// then by the number of types that remain at their end. The paths are
+// searched best-first by their length plus the distance of their last vertex
+// to the nearest leaf vertex, the search stops as soon as enough paths were
+// found instead of enumerating every path like runPathFinding.
+// With Config::MaxRemainingTypes of 0, paths whose remaining types can not be
+// acquired within MaxPathLength (see TransitionData::AcquisitionCosts) are
+// not extended. The search stops at Deadline with the paths ranked so far.
+[[nodiscard]] std::vector<PathType>
+runTopKPathFinding(const GraphData &Data, size_t MaxPathCount,
+                   std::chrono::steady_clock::time_point Deadline =
+                       std::chrono::steady_clock::time_point::max());
+
+#endif
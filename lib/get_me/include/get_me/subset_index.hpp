@@ -0,0 +1,27 @@
+#ifndef get_me_lib_get_me_include_get_me_subset_index_hpp
+#define get_me_lib_get_me_include_get_me_subset_index_hpp
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "get_me/type_id_set.hpp"
+
+// index of non-empty TypeIdSets that answers whether it contains a strict
+// subset of a queried set. Stores an inverted index from every type to the
+// sets containing it, a query only visits the sets that share a type with the
+// queried set: a set is a subset if all of its types were visited.
+class SubsetIndex {
+public:
+  void insert(const TypeIdSet &Val);
+
+  [[nodiscard]] bool containsStrictSubsetOf(const TypeIdSet &Val) const;
+
+private:
+  // the size of every inserted set, by the order of insertion
+  std::vector<std::size_t> SetSizes_;
+  boost::unordered_flat_map<TypeId, std::vector<std::size_t>> SetsWithType_;
+};
+
+#endif
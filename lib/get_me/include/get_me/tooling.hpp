@@ -2,15 +2,55 @@
 #define get_me_lib_get_me_include_get_me_tooling_hpp
 
 #include <memory>
+#include <string>
+#include <vector>
+
+#include <clang/Tooling/ArgumentsAdjusters.h>
 
 #include "get_me/config.hpp"
 #include "get_me/transitions.hpp"
 
 namespace clang {
 class ASTUnit;
-}
+namespace tooling {
+class CompilationDatabase;
+} // namespace tooling
+} // namespace clang
 
 [[nodiscard]] std::shared_ptr<TransitionData>
 collectTransitions(clang::ASTUnit &AST, std::shared_ptr<Config> Conf);
 
+// collects the transitions of every translation unit in parallel and merges
+// them into a single index. Types are identified across translation units by
+// their printed name and USR, declarations by their USR. The merged
+// transitions are detached from the ASTs, the transitions of a single
+// translation unit refer to its AST.
+[[nodiscard]] std::shared_ptr<TransitionData>
+collectTransitions(const std::vector<std::unique_ptr<clang::ASTUnit>> &ASTs,
+                   std::shared_ptr<Config> Conf);
+
+// builds the ASTs of the sources in batches of as many sources as are built in
+// parallel, and merges the transitions of each batch before its ASTs are
+// released. The transitions are detached from the ASTs.
+[[nodiscard]] std::shared_ptr<TransitionData>
+collectTransitions(const clang::tooling::CompilationDatabase &Compilations,
+                   const std::vector<std::string> &Sources,
+                   std::shared_ptr<Config> Conf,
+                   const clang::tooling::ArgumentsAdjuster &Adjuster = {});
+
+// additional compiler arguments required by the configuration, e.g., to skip
+// parsing function bodies
+[[nodiscard]] std::vector<std::string> getParseArguments(const Config &Conf);
+
+// appends getParseArguments to every compile command, the configuration is
+// read whenever the adjuster is invoked
+[[nodiscard]] clang::tooling::ArgumentsAdjuster
+getParseArgumentsAdjuster(std::shared_ptr<Config> Conf);
+
+// builds the ASTs of all sources in parallel
+[[nodiscard]] std::vector<std::unique_ptr<clang::ASTUnit>>
+buildASTs(const clang::tooling::CompilationDatabase &Compilations,
+          const std::vector<std::string> &Sources,
+          const clang::tooling::ArgumentsAdjuster &Adjuster = {});
+
 #endif
@@ -0,0 +1,36 @@
+#ifndef get_me_lib_get_me_include_get_me_transition_index_hpp
+#define get_me_lib_get_me_include_get_me_transition_index_hpp
+
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include <llvm/Support/MemoryBuffer.h>
+
+#include "get_me/transitions.hpp"
+
+// owns the memory that IndexedTypes and IndexedDecls refer to: the mapped file
+// of a loaded index, or the strings and declarations of transitions that were
+// detached from their ASTs. The deques are never shrunk, the transitions point
+// into them.
+class TransitionIndexStorage {
+public:
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::deque<std::string> Strings;
+  std::deque<IndexedDecl> Decls;
+};
+
+// Writes the committed transitions into a binary index file. Types are stored
+// by their printed name and declarations by their USR and the names needed to
+// print them, so that queries can be answered without parsing any source.
+void saveTransitionIndex(const TransitionData &Transitions,
+                         const std::filesystem::path &Path);
+
+// Memory maps the index file at Path. The types and declarations of the
+// returned transitions refer to the mapped file, which is kept alive by
+// TransitionData::IndexStorage.
+[[nodiscard]] std::shared_ptr<TransitionData>
+loadTransitionIndex(const std::filesystem::path &Path);
+
+#endif
@@ -3,7 +3,11 @@
 
 #include <cstddef>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -13,24 +17,35 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include <fmt/core.h>
-#include <range/v3/action/sort.hpp>
+#include <range/v3/action/stable_sort.hpp>
 #include <range/v3/algorithm/for_each.hpp>
 #include <range/v3/functional/compose.hpp>
 #include <range/v3/range/concepts.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/range/primitives.hpp>
+#include <range/v3/range/traits.hpp>
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/set_algorithm.hpp>
 #include <range/v3/view/transform.hpp>
 
 #include "get_me/indexed_set.hpp"
 #include "get_me/type_conversion_map.hpp"
+#include "get_me/type_name_index.hpp"
 #include "get_me/type_set.hpp"
 #include "support/ranges/functional.hpp"
 
+// declaration loaded from a transition index or detached from its AST, the
+// strings refer to the memory of TransitionData::IndexStorage
+struct IndexedDecl {
+  std::string_view USR;
+  std::string_view Name;
+  std::string_view AcquiredTypeNames;
+  std::string_view RequiredTypeNames;
+};
+
 using TransitionDataType =
     std::variant<const clang::FunctionDecl *, const clang::FieldDecl *,
-                 const clang::VarDecl *>;
+                 const clang::VarDecl *, const IndexedDecl *>;
 
 [[nodiscard]] std::string getTransitionName(const TransitionDataType &Data);
 
@@ -40,6 +55,9 @@ getTransitionAcquiredTypeNames(const TransitionDataType &Data);
 [[nodiscard]] std::string
 getTransitionRequiredTypeNames(const TransitionDataType &Data);
 
+// unified symbol resolution of the declaration, stable across translation units
+[[nodiscard]] std::string getTransitionUSR(const TransitionDataType &Data);
+
 template <> class fmt::formatter<TransitionDataType> {
 public:
   // NOLINTBEGIN(readability-convert-member-functions-to-static)
@@ -67,24 +85,72 @@ using TransitionMap =
                                indexed_value<StrippedTransitionsSet>>;
 
 using TransitionType = TransitionMap::value_type;
-using BundeledTransitionType =
-    std::pair<std::pair<TransparentType, TypeSet>, StrippedTransitionsSet>;
 
 using FlatTransitionType =
     std::tuple<TransparentType, TransitionDataType, TypeSet>;
 
+// a bundle of transitions with interned types: acquired, required and the
+// index of the bundle in TransitionData::Data
+using InternedTransitionType = std::tuple<TypeId, TypeIdSet, size_t>;
+
+class TransitionIndexStorage;
+
+// acquisition cost of a type that no sequence of transitions can acquire
+inline constexpr auto UnreachableAcquisitionCost =
+    std::numeric_limits<size_t>::max();
+
 struct TransitionData {
   using associative_container_type = TransitionMap;
   using value_type = associative_container_type::value_type;
-  using bundeled_container_type = std::vector<BundeledTransitionType>;
-  using flat_container_type = std::vector<FlatTransitionType>;
 
   void commit();
 
+  // requires commit
+  [[nodiscard]] TypeId getTypeId(const TransparentType &Val) const;
+  [[nodiscard]] TypeIdSet getTypeIds(const TypeSet &Val) const;
+  [[nodiscard]] TypeSet getTypes(const TypeIdSet &Val) const;
+  // the types whose conversions contain Acquired, i.e., the types that a
+  // transition acquiring Acquired can provide, sorted
+  [[nodiscard]] std::span<const TypeId>
+  getReverseConversions(TypeId Acquired) const;
+  // lower bound of the number of transitions needed to acquire every type of
+  // Val, the highest acquisition cost of its types
+  [[nodiscard]] size_t getAcquisitionCost(const TypeIdSet &Val) const;
+  // the bundle with the index BundleIndex, see ToBundeledTransitionIndex
+  [[nodiscard]] const TransitionType &getBundle(size_t BundleIndex) const;
+  // the number of transitions of all bundles
+  [[nodiscard]] size_t getNumTransitions() const;
+
+  // Data and ConversionMap are the transitions as they are collected,
+  // merged and serialized, see TransitionDataMerger and saveTransitionIndex.
+  // Graphs and queries only use the interned tables below and map back to
+  // the types of Data to format their results.
   associative_container_type Data;
-  bundeled_container_type BundeledData;
-  flat_container_type FlatData;
   TypeConversionMap ConversionMap;
+  // every type of Data and ConversionMap indexed by its TypeId. The types are
+  // sorted, comparing ids is equivalent to comparing the types.
+  std::vector<TransparentType> Types;
+  // Data with interned types, indexed by the index of the bundle
+  std::vector<InternedTransitionType> InternedData;
+  // the conversions of the desugared type of each interned type
+  std::vector<TypeIdSet> InternedConversions;
+  // the inverse of InternedConversions, the reverse conversions of type Id
+  // are ReverseConversions[ReverseConversionOffsets[Id],
+  // ReverseConversionOffsets[Id + 1])
+  std::vector<size_t> ReverseConversionOffsets;
+  std::vector<TypeId> ReverseConversions;
+  // the minimal number of transitions needed to acquire each type without
+  // any other types, indexed by TypeId. A transition provides the conversions
+  // of its acquired type and costs one more than its most expensive required
+  // type, a type costs as much as its cheapest transition. Never overestimates
+  // the length of a path that acquires the type.
+  std::vector<size_t> AcquisitionCosts;
+  // the printed names of the types of ConversionMap, see
+  // getQueriedTypesForInput
+  TypeNameIndex NameIndex;
+  // keeps the memory of a loaded transition index or of transitions detached
+  // from their ASTs alive, empty when the transitions refer to an AST
+  std::shared_ptr<const TransitionIndexStorage> IndexStorage;
 };
 
 namespace detail {
@@ -116,28 +182,28 @@ struct ToAcquiredFn {
   }
 
   [[nodiscard]] static constexpr TransparentType &&
-  operator()(BundeledTransitionType &&Val) {
-    return std::move(Val).first.first;
+  operator()(FlatTransitionType &&Val) {
+    return Element<0>(std::move(Val));
   }
   [[nodiscard]] static constexpr const TransparentType &
-  operator()(const BundeledTransitionType &Val) {
-    return Val.first.first;
+  operator()(const FlatTransitionType &Val) {
+    return Element<0>(Val);
   }
   [[nodiscard]] static constexpr TransparentType &
-  operator()(BundeledTransitionType &Val) {
-    return Val.first.first;
+  operator()(FlatTransitionType &Val) {
+    return Element<0>(Val);
   }
 
-  [[nodiscard]] static constexpr TransparentType &&
-  operator()(FlatTransitionType &&Val) {
+  [[nodiscard]] static constexpr TypeId &&
+  operator()(InternedTransitionType &&Val) {
     return Element<0>(std::move(Val));
   }
-  [[nodiscard]] static constexpr const TransparentType &
-  operator()(const FlatTransitionType &Val) {
+  [[nodiscard]] static constexpr const TypeId &
+  operator()(const InternedTransitionType &Val) {
     return Element<0>(Val);
   }
-  [[nodiscard]] static constexpr TransparentType &
-  operator()(FlatTransitionType &Val) {
+  [[nodiscard]] static constexpr TypeId &
+  operator()(InternedTransitionType &Val) {
     return Element<0>(Val);
   }
 };
@@ -167,19 +233,6 @@ struct ToRequiredFn {
     return Val.second;
   }
 
-  [[nodiscard]] static constexpr TypeSet &&
-  operator()(BundeledTransitionType &&Val) {
-    return std::move(Val).first.second;
-  }
-  [[nodiscard]] static constexpr const TypeSet &
-  operator()(const BundeledTransitionType &Val) {
-    return Val.first.second;
-  }
-  [[nodiscard]] static constexpr TypeSet &
-  operator()(BundeledTransitionType &Val) {
-    return Val.first.second;
-  }
-
   [[nodiscard]] static constexpr TypeSet &&
   operator()(FlatTransitionType &&Val) {
     return Element<2>(std::move(Val));
@@ -191,6 +244,19 @@ struct ToRequiredFn {
   [[nodiscard]] static constexpr TypeSet &operator()(FlatTransitionType &Val) {
     return Element<2>(Val);
   }
+
+  [[nodiscard]] static constexpr TypeIdSet &&
+  operator()(InternedTransitionType &&Val) {
+    return Element<1>(std::move(Val));
+  }
+  [[nodiscard]] static constexpr const TypeIdSet &
+  operator()(const InternedTransitionType &Val) {
+    return Element<1>(Val);
+  }
+  [[nodiscard]] static constexpr TypeIdSet &
+  operator()(InternedTransitionType &Val) {
+    return Element<1>(Val);
+  }
 };
 
 struct ToTransitionsFn {
@@ -206,19 +272,6 @@ struct ToTransitionsFn {
   operator()(TransitionType &Val) {
     return Value(Val.second);
   }
-
-  [[nodiscard]] static constexpr StrippedTransitionsSet &&
-  operator()(BundeledTransitionType &&Val) {
-    return Element<1>(std::move(Val));
-  }
-  [[nodiscard]] static constexpr const StrippedTransitionsSet &
-  operator()(const BundeledTransitionType &Val) {
-    return Element<1>(Val);
-  }
-  [[nodiscard]] static constexpr StrippedTransitionsSet &
-  operator()(BundeledTransitionType &Val) {
-    return Element<1>(Val);
-  }
 };
 
 struct ToTransitionFn {
@@ -259,6 +312,19 @@ struct ToBundeledTransitionIndexFn {
   [[nodiscard]] static constexpr size_t &operator()(TransitionType &Val) {
     return Index(Val.second);
   }
+
+  [[nodiscard]] static constexpr size_t &&
+  operator()(InternedTransitionType &&Val) {
+    return Element<2>(std::move(Val));
+  }
+  [[nodiscard]] static constexpr const size_t &
+  operator()(const InternedTransitionType &Val) {
+    return Element<2>(Val);
+  }
+  [[nodiscard]] static constexpr size_t &
+  operator()(InternedTransitionType &Val) {
+    return Element<2>(Val);
+  }
 };
 
 struct ToTransitionIndexFn {
@@ -285,9 +351,14 @@ inline constexpr detail::ToBundeledTransitionIndexFn
     ToBundeledTransitionIndex{};
 inline constexpr detail::ToTransitionIndexFn ToTransitionIndex{};
 
-[[nodiscard]] boost::container::flat_set<TransitionType>
-getSmallestIndependentTransitions(const ranges::range auto &Transitions) {
-  auto IndependentTransitions = boost::container::flat_set<TransitionType>{};
+// the transitions that are taken from a vertex: a transition is not taken if
+// an already taken transition requires its acquired type. Transitions with
+// fewer dependents are considered first, ties in the order of Transitions.
+template <ranges::range RangeType>
+[[nodiscard]] boost::container::flat_set<ranges::range_value_t<RangeType>>
+getSmallestIndependentTransitions(const RangeType &Transitions) {
+  auto IndependentTransitions =
+      boost::container::flat_set<ranges::range_value_t<RangeType>>{};
   const auto Dependencies =
       Transitions |
       ranges::views::transform([&Transitions](const auto &Transition) {
@@ -302,8 +373,8 @@ getSmallestIndependentTransitions(const ranges::range auto &Transitions) {
                              ranges::to<boost::container::flat_set>};
       }) |
       ranges::to_vector |
-      ranges::actions::sort(std::less<>{},
-                            ranges::compose(ranges::size, Element<1>));
+      ranges::actions::stable_sort(std::less<>{},
+                                   ranges::compose(ranges::size, Element<1>));
 
   ranges::for_each(
       Dependencies, [&IndependentTransitions](auto &DependenciesPair) {
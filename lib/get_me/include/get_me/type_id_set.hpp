@@ -0,0 +1,154 @@
+#ifndef get_me_lib_get_me_include_get_me_type_id_set_hpp
+#define get_me_lib_get_me_include_get_me_type_id_set_hpp
+
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+
+#include <boost/container/small_vector.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/iterator/concepts.hpp>
+#include <range/v3/view/subrange.hpp>
+
+// dense id of an interned TransparentType, see TransitionData::Types
+using TypeId = std::uint32_t;
+
+// set of TypeIds stored as a sparse bitset: a sorted list of 64-bit words
+// together with their position. Sets of small ids (the common case) are a
+// single word stored inline, sets of far apart ids only store the words that
+// contain an id. Iteration yields the ids in ascending order and the ordering
+// is the lexicographical ordering of these ids, i.e., the same as for a sorted
+// container of the ids.
+// The set keeps an order independent hash of its ids (the xor of a mixed
+// value per id) that is updated incrementally by every operation, deriving
+// a set from another one only hashes the ids that changed.
+class TypeIdSet {
+public:
+  static constexpr std::uint32_t BitsPerBlock = 64U;
+
+  struct Block {
+    std::uint32_t Index;
+    std::uint64_t Bits;
+
+    [[nodiscard]] friend bool operator==(const Block &,
+                                         const Block &) noexcept = default;
+  };
+  using BlockContainer = boost::container::small_vector<Block, 2>;
+
+  class iterator {
+  public:
+    using value_type = TypeId;
+    using difference_type = std::ptrdiff_t;
+    using reference = TypeId;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator() = default;
+    iterator(const Block *Current, const Block *End)
+        : Current_{Current},
+          End_{End},
+          Bits_{Current == End ? std::uint64_t{0U} : Current->Bits} {}
+
+    [[nodiscard]] TypeId operator*() const {
+      return (Current_->Index * BitsPerBlock) +
+             static_cast<TypeId>(std::countr_zero(Bits_));
+    }
+
+    iterator &operator++() {
+      Bits_ &= Bits_ - 1U;
+      if (Bits_ == 0U) {
+        ++Current_;
+        Bits_ = Current_ == End_ ? std::uint64_t{0U} : Current_->Bits;
+      }
+      return *this;
+    }
+    iterator operator++(int) {
+      auto Copy = *this;
+      ++*this;
+      return Copy;
+    }
+
+    [[nodiscard]] friend bool operator==(const iterator &Lhs,
+                                         const iterator &Rhs) noexcept {
+      return Lhs.Current_ == Rhs.Current_ && Lhs.Bits_ == Rhs.Bits_;
+    }
+
+  private:
+    const Block *Current_{};
+    const Block *End_{};
+    std::uint64_t Bits_{};
+  };
+  using const_iterator = iterator;
+  using value_type = TypeId;
+  using size_type = std::size_t;
+
+  TypeIdSet() = default;
+  TypeIdSet(std::initializer_list<TypeId> Ids) {
+    ranges::for_each(Ids, [this](const TypeId Id) { insert(Id); });
+  }
+  template <ranges::input_iterator Iter, ranges::sentinel_for<Iter> Sent>
+  TypeIdSet(Iter First, Sent Last) {
+    ranges::for_each(ranges::subrange(First, Last),
+                     [this](const TypeId Id) { insert(Id); });
+  }
+
+  [[nodiscard]] iterator begin() const {
+    return {Blocks_.data(), Blocks_.data() + Blocks_.size()};
+  }
+  [[nodiscard]] iterator end() const {
+    return {Blocks_.data() + Blocks_.size(), Blocks_.data() + Blocks_.size()};
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return Blocks_.empty(); }
+  [[nodiscard]] size_type size() const noexcept;
+
+  [[nodiscard]] bool contains(TypeId Id) const noexcept;
+  bool insert(TypeId Id);
+  bool erase(TypeId Id);
+
+  [[nodiscard]] const BlockContainer &blocks() const noexcept {
+    return Blocks_;
+  }
+  [[nodiscard]] std::uint64_t hash() const noexcept { return Hash_; }
+
+  // Lhs \ Rhs
+  [[nodiscard]] friend TypeIdSet setDifference(const TypeIdSet &Lhs,
+                                               const TypeIdSet &Rhs);
+  // Lhs u Rhs
+  [[nodiscard]] friend TypeIdSet setUnion(const TypeIdSet &Lhs,
+                                          const TypeIdSet &Rhs);
+  // (Lhs \ Removed) u Added, the set of types after taking a transition
+  [[nodiscard]] friend TypeIdSet
+  setDifferenceAndUnion(const TypeIdSet &Lhs, const TypeIdSet &Removed,
+                        const TypeIdSet &Added);
+  [[nodiscard]] friend bool isSubset(const TypeIdSet &Subset,
+                                     const TypeIdSet &Superset) noexcept;
+  [[nodiscard]] friend bool intersects(const TypeIdSet &Lhs,
+                                       const TypeIdSet &Rhs) noexcept;
+
+  [[nodiscard]] friend std::strong_ordering
+  operator<=>(const TypeIdSet &Lhs, const TypeIdSet &Rhs) noexcept;
+  [[nodiscard]] friend bool operator==(const TypeIdSet &Lhs,
+                                       const TypeIdSet &Rhs) noexcept {
+    return Lhs.Hash_ == Rhs.Hash_ && Lhs.Blocks_ == Rhs.Blocks_;
+  }
+
+private:
+  // invariant: sorted by Index, no block with Bits == 0
+  BlockContainer Blocks_;
+  std::uint64_t Hash_{};
+};
+
+struct TypeIdSetHash {
+  // the hash is already well distributed, no need for boost::unordered to
+  // mix it again
+  using is_avalanching = void;
+
+  [[nodiscard]] std::size_t operator()(const TypeIdSet &Val) const noexcept {
+    return static_cast<std::size_t>(Val.hash());
+  }
+};
+
+#endif
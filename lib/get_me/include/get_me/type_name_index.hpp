@@ -0,0 +1,51 @@
+#ifndef get_me_lib_get_me_include_get_me_type_name_index_hpp
+#define get_me_lib_get_me_include_get_me_type_name_index_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "get_me/type_conversion_map.hpp"
+#include "get_me/type_set.hpp"
+
+// index of the printed names of the types in the conversions of a
+// TypeConversionMap, so that resolving a name does not print every type.
+// Built once by TransitionData::commit.
+class TypeNameIndex {
+public:
+  TypeNameIndex() = default;
+  explicit TypeNameIndex(const TypeConversionMap &ConversionMap);
+
+  // the key of the first entry of the conversion map (in the order of the map)
+  // with a type whose actual spelling is Name. If there is none, the first
+  // entry with a type whose desugared spelling is Name.
+  [[nodiscard]] std::optional<Type> find(std::string_view Name) const;
+
+  // at most MaxCount names that start with Prefix, in lexicographic order
+  [[nodiscard]] std::vector<std::string>
+  findPrefixMatches(std::string_view Prefix, std::size_t MaxCount) const;
+
+  // at most MaxCount names that contain Partial, in lexicographic order.
+  // Candidates are the names that contain every trigram of Partial, shorter
+  // inputs fall back to findPrefixMatches.
+  [[nodiscard]] std::vector<std::string>
+  findPartialMatches(std::string_view Partial, std::size_t MaxCount) const;
+
+private:
+  using NameMap = boost::unordered_flat_map<std::string, Type>;
+
+  NameMap ActualNames_;
+  NameMap DesugaredNames_;
+  // the actual and desugared names, sorted and unique
+  std::vector<std::string> Names_;
+  // the indices into Names_ of the names that contain a trigram, ascending
+  boost::unordered_flat_map<std::uint32_t, std::vector<std::size_t>>
+      NamesWithTrigram_;
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <compare>
 #include <concepts>
+#include <cstdint>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -14,6 +16,7 @@
 
 #include "get_me/config.hpp"
 #include "get_me/formatting.hpp" // IWYU pragma: keep
+#include "get_me/type_id_set.hpp"
 
 namespace clang {
 class FieldDecl;
@@ -45,11 +48,43 @@ public:
   // NOLINTEND(readability-convert-member-functions-to-static)
 };
 
+// type loaded from a transition index or detached from its AST, identified by
+// its id, the name refers to the memory of TransitionData::IndexStorage
+struct IndexedType {
+  std::uint32_t Id;
+  std::string_view Name;
+
+  [[nodiscard]] friend auto operator<=>(const IndexedType &Lhs,
+                                        const IndexedType &Rhs) noexcept {
+    return Lhs.Id <=> Rhs.Id;
+  }
+  [[nodiscard]] friend bool operator==(const IndexedType &Lhs,
+                                       const IndexedType &Rhs) noexcept {
+    return Lhs.Id == Rhs.Id;
+  }
+};
+
+template <> class fmt::formatter<IndexedType> {
+public:
+  // NOLINTBEGIN(readability-convert-member-functions-to-static)
+  [[nodiscard]] constexpr format_parse_context::iterator
+  parse(format_parse_context &Ctx) {
+    return Ctx.begin();
+  }
+
+  [[nodiscard]] format_context::iterator format(const IndexedType &Val,
+                                                format_context &Ctx) const {
+    return fmt::format_to(Ctx.out(), "{}", Val.Name);
+  }
+  // NOLINTEND(readability-convert-member-functions-to-static)
+};
+
 [[nodiscard]] clang::QualType launderType(const clang::QualType &Type);
 
-class Type : public std::variant<clang::QualType, ArithmeticType> {
+class Type
+    : public std::variant<clang::QualType, ArithmeticType, IndexedType> {
 public:
-  using Base = std::variant<clang::QualType, ArithmeticType>;
+  using Base = std::variant<clang::QualType, ArithmeticType, IndexedType>;
   using Base::variant;
 
   // force launder of all QualTypes for TypeSetValue
@@ -70,6 +105,9 @@ public:
     if (std::holds_alternative<ArithmeticType>(Lhs)) {
       return std::strong_ordering::equal;
     }
+    if (std::holds_alternative<IndexedType>(Lhs)) {
+      return std::get<IndexedType>(Lhs) <=> std::get<IndexedType>(Rhs);
+    }
 
     const auto LQT = std::get<clang::QualType>(Lhs);
     const auto RQT = std::get<clang::QualType>(Rhs);
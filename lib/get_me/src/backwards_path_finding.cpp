@@ -1,14 +1,20 @@
 
 #include "get_me/backwards_path_finding.hpp"
 
+#include <chrono>
 #include <cstddef>
 #include <functional>
+#include <optional>
 #include <stack>
 #include <utility>
+#include <vector>
 
-#include <range/v3/action/action.hpp>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/task_arena.h>
+#include <range/v3/action/push_back.hpp>
 #include <range/v3/action/reverse.hpp>
 #include <range/v3/action/sort.hpp>
+#include <range/v3/algorithm/all_of.hpp>
 #include <range/v3/algorithm/any_of.hpp>
 #include <range/v3/algorithm/contains.hpp>
 #include <range/v3/algorithm/find.hpp>
@@ -16,146 +22,228 @@
 #include <range/v3/iterator/operations.hpp>
 #include <range/v3/range/concepts.hpp>
 #include <range/v3/range/conversion.hpp>
-#include <range/v3/range/operations.hpp>
 #include <range/v3/range/primitives.hpp>
 #include <range/v3/view/filter.hpp>
+#include <range/v3/view/join.hpp>
+#include <range/v3/view/move.hpp>
 
+#include "get_me/config.hpp"
 #include "get_me/graph.hpp"
+#include "support/get_me_exception.hpp"
 #include "support/ranges/functional.hpp"
 
 namespace {
+// the number of prefixes of the parallel path finding per thread, so that
+// prefixes with large subtrees are balanced by the others
+constexpr size_t PrefixesPerThread = 8U;
+
+// whether a prefix of the backwards search is a complete path
+[[nodiscard]] bool startsAtRoot(const GraphData &Data, const PathType &Prefix) {
+  return Data.RootVertices.test(Source(ranges::back(Prefix)));
+}
+
 template <ranges::range RangeType>
 void push(std::stack<TransitionEdgeType> &Stack, RangeType &&Range) {
   ranges::for_each(std::forward<RangeType>(Range),
                    [&Stack](const auto &Value) { Stack.push(Value); });
 }
+} // namespace
+
+std::vector<TransitionEdgeType> getStartEdges(const GraphData &Data) {
+  const auto TerminatesInLeaf = [&Data](const TransitionEdgeType &Step) {
+    return Data.LeafVertices.test(Target(Step));
+  };
+  return Data.Edges |
+         ranges::views::filter(Less(Data.Conf->MaxPathLength),
+                               Lookup(Data.VertexDepth, Source)) |
+         ranges::views::filter(TerminatesInLeaf) | ranges::to_vector |
+         ranges::actions::sort(std::greater{},
+                               Lookup(Data.VertexDepth, Target));
+}
+
+PathGenerator::PathGenerator(
+    const GraphData &Data, const std::chrono::steady_clock::time_point Deadline)
+    : Data_{&Data},
+      Deadline_{Deadline} {
+  push(EdgesStack_, getStartEdges(Data));
+}
+
+PathGenerator::PathGenerator(const GraphData &Data, PathType Prefix)
+    : Data_{&Data},
+      CurrentPath_{std::move(Prefix)} {
+  GetMeException::verify(
+      !ranges::empty(CurrentPath_) &&
+          !Data.RootVertices.test(Source(ranges::back(CurrentPath_))),
+      "PathGenerator(): the prefix is empty or starts at a root vertex");
+  push(EdgesStack_, Data.getIncomingEdges(Source(ranges::back(CurrentPath_))));
+}
+
+std::optional<PathType> PathGenerator::next() {
+  while (!EdgesStack_.empty() &&
+         std::chrono::steady_clock::now() < Deadline_) {
+    const auto Edge = EdgesStack_.top();
+    EdgesStack_.pop();
+
+    if (shouldSkip(Edge)) {
+      continue;
+    }
 
-class StateType {
-public:
-  void addEdge(const TransitionEdgeType &Edge) {
     CurrentPath_.emplace_back(Edge);
-  }
 
-  void finishPath() {
-    Paths_.emplace(Copy(CurrentPath_) | ranges::actions::reverse);
-  }
+    if (!Data_->RootVertices.test(Source(Edge))) {
+      // the out edges of the backwards search are the incoming edges of the
+      // graph
+      push(EdgesStack_, Data_->getIncomingEdges(Source(Edge)));
+      continue;
+    }
 
-  [[nodiscard]] bool rollbackPathIfRequired(const TransitionEdgeType &Edge) {
-    if (requiresRollback(Edge)) {
-      rollbackFor(Edge);
-      return true;
+    if (FoundSignatures_.emplace(getPathSignature(CurrentPath_, *Data_))
+            .second) {
+      return Copy(CurrentPath_) | ranges::actions::reverse;
     }
-    return false;
   }
 
-  [[nodiscard]] bool shouldIgnore(const TransitionEdgeType &Edge) const {
-    return ranges::any_of(
-        CurrentPath_, [&Edge](const TransitionEdgeType &EdgeInPath) {
-          return EdgeInPath.TransitionIndex == Edge.TransitionIndex ||
-                 Source(EdgeInPath) == Source(Edge);
-        });
+  return std::nullopt;
+}
+
+std::vector<PathType> PathGenerator::split() {
+  // takes the edges like next, every taken edge rolls the path of the previous
+  // one back before it is checked
+  auto Prefixes = std::vector<PathType>{};
+  while (!EdgesStack_.empty()) {
+    const auto Edge = EdgesStack_.top();
+    EdgesStack_.pop();
+    if (shouldSkip(Edge)) {
+      continue;
+    }
+    CurrentPath_.emplace_back(Edge);
+    Prefixes.push_back(CurrentPath_);
   }
+  return Prefixes;
+}
 
-  [[nodiscard]] const PathType &getCurrentPath() const { return CurrentPath_; }
+bool PathGenerator::rollbackPathIfRequired(const TransitionEdgeType &Edge) {
+  if (CurrentPath_.empty() ||
+      Source(ranges::back(CurrentPath_)) == Target(Edge)) {
+    return false;
+  }
 
-  [[nodiscard]] size_t getNumPaths() const { return ranges::size(Paths_); }
+  // visiting an edge whose source is not the target of the previous edge.
+  // the current path has to be reverted until the new edge can be added
+  // to the path remove edges that were added after the path got to src
+  const auto EraseIter = ranges::find(CurrentPath_, Target(Edge), Source);
+  const auto End = CurrentPath_.end();
+  if (EraseIter != End) {
+    CurrentPath_.erase(ranges::next(EraseIter), End);
+  } else {
+    CurrentPath_.clear();
+  }
+  return true;
+}
 
-  [[nodiscard]] PathContainer takePaths() { return std::move(Paths_); }
+bool PathGenerator::shouldIgnore(const TransitionEdgeType &Edge) const {
+  return ranges::contains(CurrentPath_, Source(Edge), Source) ||
+         !canTakeDistinctTransitions(*Data_, CurrentPath_, Edge);
+}
 
-private:
-  PathContainer Paths_;
-  PathType CurrentPath_;
+bool PathGenerator::isSkippableNonCanonicalOrder(
+    const TransitionEdgeType &Edge) const {
+  const auto &Second = ranges::back(CurrentPath_);
+  // the swapped path takes the edges of the current path after Swapped, the
+  // same depth limit applies to it
+  return ranges::any_of(
+      getSwappedOrderVertices(*Data_, Edge, Second),
+      [this, &Edge, &Second](const VertexDescriptor Swapped) {
+        return SafePlus(CurrentPath_.size(), Data_->VertexDepth[Swapped]) <=
+                   Data_->Conf->MaxPathLength &&
+               canSwapOrderThrough(*Data_, CurrentPath_, Edge, Second,
+                                   Swapped);
+      });
+}
 
-  [[nodiscard]] bool requiresRollback(const TransitionEdgeType &Edge) const {
-    return !CurrentPath_.empty() &&
-           Source(ranges::back(CurrentPath_)) != Target(Edge);
+bool PathGenerator::shouldSkip(const TransitionEdgeType &Edge) {
+  if (const auto RolledBack = rollbackPathIfRequired(Edge); RolledBack) {
+    if (Data_->Conf->EnableGraphBackwardsEdge &&
+        ranges::contains(CurrentPath_, Target(Edge), Target)) {
+      return true;
+    }
+  } else {
+    if (Data_->Conf->EnableGraphBackwardsEdge && !ranges::empty(CurrentPath_) &&
+        Target(ranges::back(CurrentPath_)) == Target(Edge)) {
+      return true;
+    }
   }
 
-  void rollbackFor(const TransitionEdgeType &Edge) {
-    // visiting an edge whose source is not the target of the previous edge.
-    // the current path has to be reverted until the new edge can be added
-    // to the path remove edges that were added after the path got to src
-    const auto EraseIter = ranges::find(CurrentPath_, Target(Edge), Source);
-    const auto End = CurrentPath_.end();
-    if (EraseIter != End) {
-      CurrentPath_.erase(ranges::next(EraseIter), End);
-    } else {
-      CurrentPath_.clear();
-    }
+  if (shouldIgnore(Edge)) {
+    return true;
   }
-};
 
-} // namespace
+  // the current path is built backwards, Edge is taken before its last edge
+  if (Data_->Conf->EnablePathOrderReduction && !CurrentPath_.empty() &&
+      isSkippableNonCanonicalOrder(Edge)) {
+    return true;
+  }
 
-PathContainer runPathFinding(GraphData &Data) {
-  const auto &Edges = Data.Edges;
+  const auto MinPathLengthWhenTakingEdge =
+      SafePlus(CurrentPath_.size(), Data_->VertexDepth[Target(Edge)]);
+  return MinPathLengthWhenTakingEdge > Data_->Conf->MaxPathLength;
+}
 
-  const auto Roots = getRootVertices(Data);
-  const auto Leafs = getLeafVertices(Data);
-  const auto TerminatesInLeaf = [&Leafs](const TransitionEdgeType &Step) {
-    return ranges::contains(Leafs, Target(Step));
+std::vector<PathType> splitPathSearch(const GraphData &Data,
+                                      const size_t MinNumPrefixes) {
+  auto Prefixes = PathGenerator{Data}.split();
+  const auto StartsAtRoot = [&Data](const PathType &Prefix) {
+    return startsAtRoot(Data, Prefix);
   };
-  const auto StartEdges =
-      Edges |
-      ranges::views::filter(Less(Data.Conf->MaxPathLength),
-                            Lookup(Data.VertexDepth, Source)) |
-      ranges::views::filter(TerminatesInLeaf) | ranges::to_vector |
-      ranges::actions::sort(std::greater{}, Lookup(Data.VertexDepth, Target));
-
-  const auto GetOutEdgesOfVertex =
-      [&Edges, &Data](const VertexDescriptor SourceVertex) {
-        return Edges | ranges::views::filter(EqualTo(SourceVertex), Target) |
-               ranges::to_vector |
-               ranges::actions::sort(std::greater{},
-                                     Lookup(Data.VertexDepth, Target));
-      };
-
-  auto EdgesStack = std::stack<TransitionEdgeType>{};
-  push(EdgesStack, StartEdges);
-
-  const auto AddOutEdgesOfVertexToStack =
-      [&EdgesStack, GetOutEdgesOfVertex](const VertexDescriptor SourceVertex) {
-        push(EdgesStack, GetOutEdgesOfVertex(SourceVertex));
-      };
-
-  auto State = StateType{};
-
-  while (!EdgesStack.empty()) {
-    const auto Edge = EdgesStack.top();
-    EdgesStack.pop();
-
-    if (const auto RolledBack = State.rollbackPathIfRequired(Edge);
-        RolledBack) {
-      if (Data.Conf->EnableGraphBackwardsEdge &&
-          ranges::contains(State.getCurrentPath(), Target(Edge), Target)) {
-        continue;
-      }
-    } else {
-      if (Data.Conf->EnableGraphBackwardsEdge &&
-          !ranges::empty(State.getCurrentPath()) &&
-          Target(ranges::back(State.getCurrentPath())) == Target(Edge)) {
-        continue;
+  while (Prefixes.size() < MinNumPrefixes &&
+         !ranges::all_of(Prefixes, StartsAtRoot)) {
+    auto Split = std::vector<PathType>{};
+    ranges::for_each(Prefixes, [&Data, &Split](PathType &Prefix) {
+      if (startsAtRoot(Data, Prefix)) {
+        Split.push_back(std::move(Prefix));
+        return;
       }
-    }
-
-    if (State.shouldIgnore(Edge)) {
-      continue;
-    }
-
-    if (const auto MinPathLengthWhenTakingEdge = SafePlus(
-            State.getCurrentPath().size(), Data.VertexDepth[Target(Edge)]);
-        MinPathLengthWhenTakingEdge > Data.Conf->MaxPathLength) {
-      continue;
-    }
+      ranges::push_back(Split, PathGenerator{Data, std::move(Prefix)}.split());
+    });
+    Prefixes = std::move(Split);
+  }
+  return Prefixes;
+}
 
-    State.addEdge(Edge);
+PathContainer runPathFinding(const GraphData &Data) {
+  auto Paths = PathContainer{Data};
+  const auto InsertPath = [&Paths](PathType Path) {
+    Paths.insert(std::move(Path));
+  };
 
-    if (ranges::contains(Roots, Source(Edge))) {
-      State.finishPath();
-    } else {
-      AddOutEdgesOfVertexToStack(Source(Edge));
-    }
+  if (!Data.Conf->EnableParallelPathFinding) {
+    ranges::for_each(generatePaths(Data), InsertPath);
+    return Paths;
   }
 
-  return State.takePaths();
+  // the searches of different prefixes are independent, every prefix is
+  // searched by its own task into its own buffer
+  const auto Prefixes = splitPathSearch(
+      Data, SafeMultiplies(static_cast<size_t>(
+                               tbb::this_task_arena::max_concurrency()),
+                           PrefixesPerThread));
+  auto PathsOfPrefixes = std::vector<std::vector<PathType>>(Prefixes.size());
+  tbb::parallel_for(
+      size_t{0U}, Prefixes.size(),
+      [&Data, &Prefixes, &PathsOfPrefixes](const size_t PrefixIndex) {
+        const auto &Prefix = Prefixes[PrefixIndex];
+        if (startsAtRoot(Data, Prefix)) {
+          PathsOfPrefixes[PrefixIndex].push_back(Copy(Prefix) |
+                                                 ranges::actions::reverse);
+          return;
+        }
+        PathsOfPrefixes[PrefixIndex] =
+            toLazyRange(PathGenerator{Data, Prefix}) | ranges::to_vector;
+      });
+
+  // merge in the order of the sequential search, so that the same
+  // permutations are kept
+  ranges::for_each(PathsOfPrefixes | ranges::views::join | ranges::views::move,
+                   InsertPath);
+  return Paths;
 }
@@ -1,39 +1,63 @@
 #include "get_me/graph.hpp"
 
+#include <chrono>
+#include <compare>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/container/flat_set.hpp>
+#include <boost/dynamic_bitset/dynamic_bitset.hpp>
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_selectors.hpp>
+#include <boost/graph/strong_components.hpp>
+#include <boost/property_map/property_map.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
 #include <fmt/core.h>
 #include <fmt/format.h>
-#include <range/v3/action/push_back.hpp>
+#include <oneapi/tbb/parallel_for.h>
+#include <range/v3/action/remove_if.hpp>
 #include <range/v3/action/sort.hpp>
+#include <range/v3/action/stable_sort.hpp>
 #include <range/v3/action/unique.hpp>
+#include <range/v3/algorithm/adjacent_find.hpp>
+#include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+#include <range/v3/algorithm/binary_search.hpp>
 #include <range/v3/algorithm/contains.hpp>
+#include <range/v3/algorithm/equal.hpp>
+#include <range/v3/algorithm/equal_range.hpp>
 #include <range/v3/algorithm/fold_left.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/algorithm/lower_bound.hpp>
+#include <range/v3/algorithm/none_of.hpp>
 #include <range/v3/functional/bind_back.hpp>
 #include <range/v3/functional/comparisons.hpp>
 #include <range/v3/functional/compose.hpp>
 #include <range/v3/functional/not_fn.hpp>
+#include <range/v3/iterator/operations.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/range/operations.hpp>
 #include <range/v3/range/primitives.hpp>
-#include <range/v3/utility/tuple_algorithm.hpp>
-#include <range/v3/view/cartesian_product.hpp>
+#include <range/v3/view/chunk_by.hpp>
 #include <range/v3/view/concat.hpp>
-#include <range/v3/view/drop.hpp>
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/filter.hpp>
+#include <range/v3/view/for_each.hpp>
 #include <range/v3/view/indices.hpp>
 #include <range/v3/view/map.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/partial_sum.hpp>
 #include <range/v3/view/repeat.hpp>
 #include <range/v3/view/repeat_n.hpp>
 #include <range/v3/view/set_algorithm.hpp>
@@ -41,6 +65,7 @@
 #include <range/v3/view/subrange.hpp>
 #include <range/v3/view/take_while.hpp>
 #include <range/v3/view/transform.hpp>
+#include <range/v3/view/unique.hpp>
 #include <range/v3/view/zip.hpp>
 
 #include "get_me/config.hpp"
@@ -56,70 +81,127 @@
 namespace {
 [[nodiscard]] bool
 edgeWithTransitionExistsInContainer(const GraphData::EdgeContainer &Edges,
-                                    const TransitionEdgeType &EdgeToAdd,
-                                    const TransitionType &Transition) {
+                                    const TransitionEdgeType &EdgeToAdd) {
   return ranges::contains(
       ranges::subrange(Edges.lower_bound(EdgeToAdd),
                        Edges.upper_bound(EdgeToAdd)) |
           ranges::views::transform(&TransitionEdgeType::TransitionIndex),
-      ToBundeledTransitionIndex(Transition));
+      EdgeToAdd.TransitionIndex);
 }
 
-[[nodiscard]] TransitionType
-replaceAcquiredTypeOfTransition(const TransparentType &ConversionTypeOfAcquired,
-                                TransitionType Transition) {
+[[nodiscard]] InternedTransitionType
+replaceAcquiredTypeOfTransition(const TypeId ConversionTypeOfAcquired,
+                                InternedTransitionType Transition) {
   ToAcquired(Transition) = ConversionTypeOfAcquired;
   return Transition;
 }
 
-[[nodiscard]] auto generateTransitionsFromConversionTypes(
-    const boost::container::flat_set<Type> &PossibleConversionsTypesForAcquired,
-    const GraphBuilder::VertexType &InterestingVertex,
-    const TransitionType &Transition) {
-  const auto MatchingTypes = ranges::views::set_intersection(
-      InterestingVertex, PossibleConversionsTypesForAcquired, ranges::less{},
-      &TransparentType::Desugared);
-  return MatchingTypes | ranges::views::transform(ranges::bind_back(
-                             replaceAcquiredTypeOfTransition, Transition));
+// the transitions of the queries for each type, i.e., the transitions that
+// acquire one of the conversions of the type, with their acquired type
+// replaced by the type. Sorted by the replaced acquired type.
+using TransitionsByTypeIndex = std::vector<InternedTransitionType>;
+
+[[nodiscard]] TransitionsByTypeIndex
+buildTransitionsByTypeIndex(const TransitionData &Transitions,
+                            const std::vector<TypeIdSet> &Queries) {
+  // filtered after the replacement, like the transitions of a shared
+  // ExpansionCache
+  return getTransitionsForQuery(
+             Transitions,
+             Transitions.InternedData |
+                 ranges::views::for_each(
+                     [&Transitions](const InternedTransitionType &Transition) {
+                       return Transitions.getReverseConversions(
+                                  ToAcquired(Transition)) |
+                              ranges::views::transform(ranges::bind_back(
+                                  replaceAcquiredTypeOfTransition,
+                                  Transition));
+                     }) |
+                 ranges::to_vector,
+             Queries) |
+         ranges::actions::stable_sort(std::less<>{}, ToAcquired);
 }
 
-using FoldType =
-    std::vector<std::pair<GraphBuilder::VertexSet::value_type,
-                          boost::container::flat_set<TransitionType>>>;
-[[nodiscard]] FoldType constructVertexAndTransitionsPairVector(
-    GraphBuilder::VertexSet InterestingVertices,
-    const TransitionMap &Transitions, const TypeConversionMap &ConversionMap) {
+[[nodiscard]] std::vector<InternedTransitionType>
+lookupTransitionsForVertex(const TransitionData &Transitions,
+                           const TransitionsByTypeIndex &TransitionsByType,
+                           const GraphBuilder::VertexType &InterestingVertex) {
+  const auto HasSameDesugaredType = [&Transitions](const TypeId Lhs,
+                                                   const TypeId Rhs) {
+    return std::is_eq(Transitions.Types[Lhs].Desugared <=>
+                      Transitions.Types[Rhs].Desugared);
+  };
+  // only the first type of each desugared type is matched. The transitions
+  // are ordered by the types of the vertex and then like the transition map,
+  // which orders the ties of getSmallestIndependentTransitions.
+  return InterestingVertex | ranges::views::unique(HasSameDesugaredType) |
+         ranges::views::for_each([&TransitionsByType](const TypeId Type) {
+           return ranges::equal_range(TransitionsByType, Type, std::less<>{},
+                                      ToAcquired);
+         }) |
+         ranges::to_vector;
+}
+
+// the number of root vertices a query of several types may have at most. The
+// root vertices are the cartesian product of the queries, e.g., three queried
+// types with 20 conversions each already produce 8000 of them.
+constexpr size_t MaxQueryVertices = 4096U;
+
+// the root vertices of a query of several types: one vertex for every
+// combination of one type of each query, in ascending order. Types that are in
+// multiple queries are only contained once.
+[[nodiscard]] std::vector<GraphBuilder::VertexType>
+getQueryVertices(const TransitionData &Transitions,
+                 const std::vector<TypeSet> &Queries) {
+  using VertexType = GraphBuilder::VertexType;
+  const auto NumCombinations = ranges::fold_left(
+      Queries | ranges::views::transform(ranges::size), size_t{1U},
+      SafeMultiplies);
+  GetMeException::verify(NumCombinations <= MaxQueryVertices,
+                         "getQueryVertices(): the queried types have {} "
+                         "combinations of their conversions, at most {} are "
+                         "supported",
+                         NumCombinations, MaxQueryVertices);
   return ranges::fold_left(
-      Transitions,
-      ranges::views::zip(
-          InterestingVertices,
-          ranges::views::repeat(boost::container::flat_set<TransitionType>{})) |
-          ranges::to<FoldType>,
-      [&ConversionMap](const FoldType &VertexAndTransitionsPairs,
-                       const TransitionType &Transition) {
-        const auto PossibleConversionsTypesForAcquired =
-            ConversionMap |
-            ranges::views::filter(
-                ranges::bind_back(ranges::contains, ToAcquired(Transition)),
-                Value) |
-            ranges::views::keys | ranges::to<boost::container::flat_set<Type>>;
-        return VertexAndTransitionsPairs |
-               ranges::views::transform([&PossibleConversionsTypesForAcquired,
-                                         &Transition](const auto &Pair) {
-                 const auto &[Vertex, TransitionsVec] = Pair;
-                 return std::pair{
-                     Vertex, getSmallestIndependentTransitions(
-                                 ranges::views::concat(
-                                     TransitionsVec,
-                                     generateTransitionsFromConversionTypes(
-                                         PossibleConversionsTypesForAcquired,
-                                         Value(Vertex), Transition)) |
-                                 ranges::to_vector)};
-               }) |
-               ranges::to<FoldType>;
-      });
+             Queries, std::vector{VertexType{}},
+             [&Transitions](const std::vector<VertexType> &Combinations,
+                            const TypeSet &Query) {
+               const auto Ids = Transitions.getTypeIds(Query);
+               return Combinations |
+                      ranges::views::for_each(
+                          [&Ids](const VertexType &Combination) {
+                            return Ids | ranges::views::transform(
+                                             [&Combination](const TypeId Id) {
+                                               auto Extended = Combination;
+                                               Extended.insert(Id);
+                                               return Extended;
+                                             });
+                          }) |
+                      ranges::to_vector;
+             }) |
+         ranges::actions::sort | ranges::actions::unique;
+}
+
+// a path of a query of several types acquires each of them, the depth and
+// length limits of a single type are scaled by their number
+[[nodiscard]] std::shared_ptr<Config>
+scaleConfigForQueries(std::shared_ptr<Config> Conf, const size_t NumQueries) {
+  if (NumQueries <= 1U) {
+    return Conf;
+  }
+  auto Scaled = std::make_shared<Config>(*Conf);
+  Scaled->MaxGraphDepth = SafeMultiplies(Conf->MaxGraphDepth, NumQueries);
+  Scaled->MaxPathLength = SafeMultiplies(Conf->MaxPathLength, NumQueries);
+  return Scaled;
 }
 
+using IndexedVertexType = indexed_value<GraphBuilder::VertexType>;
+// the transitions taken from a vertex and the type set of their target vertex
+using TransitionAndTargetVector =
+    std::vector<std::pair<InternedTransitionType, GraphBuilder::VertexType>>;
+using VertexExpansionVector =
+    std::vector<std::pair<IndexedVertexType, TransitionAndTargetVector>>;
+
 // FIXME: this should be a positive match? would probably be cheaper to compute
 [[nodiscard]] std::vector<VertexDescriptor>
 getVerticesThatAreNotA(const GraphData &Data,
@@ -131,6 +213,102 @@ getVerticesThatAreNotA(const GraphData &Data,
              ranges::views::indices(Data.VertexData.size()), Vertices) |
          ranges::to_vector;
 }
+
+[[nodiscard]] boost::dynamic_bitset<>
+getVerticesWithoutEdgesAt(const GraphData &Data,
+                          const auto SourceOrTargetProjection) {
+  auto Vertices = boost::dynamic_bitset<>{Data.VertexData.size()};
+  Vertices.set();
+  ranges::for_each(Data.Edges |
+                       ranges::views::transform(SourceOrTargetProjection),
+                   [&Vertices](const VertexDescriptor Vertex) {
+                     Vertices.reset(Vertex);
+                   });
+  return Vertices;
+}
+
+[[nodiscard]] std::vector<size_t>
+getStronglyConnectedComponents(const GraphData &Data) {
+  using ComponentGraph =
+      boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS>;
+  const auto Edges = Data.Edges |
+                     ranges::views::transform(&TransitionEdgeType::Edge) |
+                     ranges::to_vector;
+  const auto Graph =
+      ComponentGraph{Edges.begin(), Edges.end(), Data.VertexData.size()};
+  auto Components = std::vector<size_t>(Data.VertexData.size());
+  boost::strong_components(
+      Graph, boost::make_iterator_property_map(
+                 Components.begin(), boost::get(boost::vertex_index, Graph)));
+  return Components;
+}
+
+[[nodiscard]] bool haveSameVertices(const TransitionEdgeType &Lhs,
+                                    const TransitionEdgeType &Rhs) {
+  return Lhs.Edge == Rhs.Edge;
+}
+
+// the edges are ordered by their vertices first, parallel edges are adjacent
+// and ordered by their transition index. Every bundled edge stores its index,
+// which keys its transitions in GraphData::EdgeTransitionOffsets.
+[[nodiscard]] GraphData::EdgeContainer
+bundleParallelEdges(const GraphData::EdgeContainer &Edges) {
+  return Edges | ranges::views::chunk_by(haveSameVertices) |
+         ranges::views::enumerate |
+         ranges::views::transform([](const auto IndexedParallelEdges) {
+           auto Edge = ranges::front(Value(IndexedParallelEdges));
+           Edge.EdgeIndex = Index(IndexedParallelEdges);
+           return Edge;
+         }) |
+         ranges::to<GraphData::EdgeContainer>;
+}
+
+[[nodiscard]] std::vector<size_t>
+getParallelEdgeOffsets(const GraphData::EdgeContainer &Edges) {
+  return ranges::views::concat(
+             ranges::views::single(size_t{0U}),
+             Edges | ranges::views::chunk_by(haveSameVertices) |
+                 ranges::views::transform([](const auto ParallelEdges) {
+                   return static_cast<size_t>(ranges::distance(ParallelEdges));
+                 }) |
+                 ranges::views::partial_sum) |
+         ranges::to_vector;
+}
+
+[[nodiscard]] std::vector<FlatPathEdge>
+getFlatTransitionsOfEdge(const TransitionEdgeType &Edge,
+                         const GraphData &Data) {
+  return Data.getEdgeTransitions(Edge) |
+         ranges::views::for_each([&Data, &Edge](const size_t TransitionIndex) {
+           const auto &Transitions = *Data.Transitions;
+           const auto &Transition = Transitions.InternedData[TransitionIndex];
+           const auto &Acquired = Transitions.Types[ToAcquired(Transition)];
+           auto Required = Transitions.getTypes(ToRequired(Transition));
+           return ToTransitions(Transitions.getBundle(TransitionIndex)) |
+                  ranges::views::values |
+                  ranges::views::transform(
+                      [&Edge, &Acquired, Required = std::move(Required)](
+                          const TransitionDataType &Function) {
+                        return FlatPathEdge{
+                            Edge.Edge,
+                            FlatTransitionType{Acquired, Function, Required}};
+                      });
+         }) |
+         ranges::to_vector;
+}
+
+// the transition index of every flattened transition of
+// getFlatTransitionsOfEdge, in the same order
+[[nodiscard]] std::vector<size_t>
+getTransitionIndicesOfEdge(const TransitionEdgeType &Edge,
+                           const GraphData &Data) {
+  return Data.getEdgeTransitions(Edge) |
+         ranges::views::for_each([&Data](const size_t TransitionIndex) {
+           return ToTransitions(Data.Transitions->getBundle(TransitionIndex)) |
+                  ranges::views::transform(ToTransitionIndex);
+         }) |
+         ranges::to_vector;
+}
 } // namespace
 
 GraphData::GraphData(std::vector<TypeSet> VertexData,
@@ -139,100 +317,314 @@ GraphData::GraphData(std::vector<TypeSet> VertexData,
                      std::shared_ptr<Config> Conf)
     : VertexData{std::move(VertexData)},
       VertexDepth{std::move(VertexDepth)},
-      Edges{std::move(Edges)},
+      Edges{bundleParallelEdges(Edges)},
+      EdgeTransitions{Edges |
+                      ranges::views::transform(
+                          &TransitionEdgeType::TransitionIndex) |
+                      ranges::to_vector},
+      EdgeTransitionOffsets{getParallelEdgeOffsets(Edges)},
+      IncomingEdges{this->Edges | ranges::to_vector |
+                    ranges::actions::stable_sort(std::less{}, Target)},
+      IncomingEdgeOffsets{
+          ranges::views::indices(this->VertexData.size() + 1U) |
+          ranges::views::transform([this](const VertexDescriptor Vertex) {
+            return static_cast<size_t>(ranges::distance(
+                IncomingEdges.begin(),
+                ranges::lower_bound(IncomingEdges, Vertex, std::less{},
+                                    Target)));
+          }) |
+          ranges::to_vector},
+      RootVertices{getVerticesWithoutEdgesAt(*this, Target)},
+      LeafVertices{getVerticesWithoutEdgesAt(*this, Source)},
+      VertexComponents{getStronglyConnectedComponents(*this)},
       Transitions{std::move(Transitions)},
       Conf{std::move(Conf)} {}
 
+std::span<const TransitionEdgeType>
+GraphData::getIncomingEdges(const VertexDescriptor Vertex) const {
+  return std::span{IncomingEdges}.subspan(IncomingEdgeOffsets[Vertex],
+                                          IncomingEdgeOffsets[Vertex + 1U] -
+                                              IncomingEdgeOffsets[Vertex]);
+}
+
+std::span<const size_t>
+GraphData::getEdgeTransitions(const TransitionEdgeType &Edge) const {
+  return std::span{EdgeTransitions}.subspan(
+      EdgeTransitionOffsets[Edge.EdgeIndex],
+      EdgeTransitionOffsets[Edge.EdgeIndex + 1U] -
+          EdgeTransitionOffsets[Edge.EdgeIndex]);
+}
+
+PathSignature getPathSignature(const PathType &Path, const GraphData &Data) {
+  return Path |
+         ranges::views::transform([&Data](const TransitionEdgeType &Edge) {
+           return Data.getEdgeTransitions(Edge) | ranges::to_vector;
+         }) |
+         ranges::to_vector | ranges::actions::sort;
+}
+
+bool PathContainer::insert(PathType Path) {
+  if (!Signatures_.emplace(getPathSignature(Path, *Data_)).second) {
+    return false;
+  }
+  Paths_.emplace_back(std::move(Path));
+  return true;
+}
+
 std::vector<std::vector<FlatPathEdge>>
 expandAndFlattenPath(const PathType &Path, const GraphData &Data) {
-  const auto ExpandEdge =
-      [&Data](const TransitionEdgeType &Edge) -> decltype(auto) {
-    const auto &Transition =
-        Data.Transitions->BundeledData[Edge.TransitionIndex];
-    return ranges::views::zip(
-        ranges::views::repeat(Edge.Edge),
-        ranges::views::zip(ranges::views::repeat(ToAcquired(Transition)),
-                           ToTransitions(Transition) | ranges::views::values,
-                           ranges::views::repeat(ToRequired(Transition))));
-  };
-  auto ExpandedPath =
-      Path | ranges::views::transform(ExpandEdge) | ranges::to_vector;
-  if (ranges::empty(ExpandedPath)) {
-    return {};
+  return generateFlatPaths(Path, Data) | ranges::to_vector;
+}
+
+FlatPathGenerator::FlatPathGenerator(const PathType &Path,
+                                     const GraphData &Data)
+    : EdgeAlternatives_{Path |
+                        ranges::views::transform(
+                            ranges::bind_back(getFlatTransitionsOfEdge, Data)) |
+                        ranges::to_vector},
+      EdgeAlternativeTransitions_{
+          Path |
+          ranges::views::transform(
+              ranges::bind_back(getTransitionIndicesOfEdge, Data)) |
+          ranges::to_vector},
+      AlternativeIndices_(EdgeAlternatives_.size(), size_t{0U}),
+      Exhausted_{EdgeAlternatives_.empty()} {}
+
+std::optional<std::vector<FlatPathEdge>> FlatPathGenerator::next() {
+  while (!Exhausted_ && !takesDistinctTransitions()) {
+    advance();
   }
-  return ranges::fold_left(
-      ExpandedPath | ranges::views::drop(1),
-      ranges::front(ExpandedPath) |
-          ranges::views::transform([](const auto &Expanded) {
-            return std::vector{
-                ranges::tuple_apply(Construct<FlatPathEdge>, Expanded)};
-          }) |
-          ranges::to<std::vector<std::vector<FlatPathEdge>>>,
-      [](const std::vector<std::vector<FlatPathEdge>> &FoldRange,
-         const auto &ExpandedPathStep) {
-        return ranges::views::cartesian_product(FoldRange, ExpandedPathStep) |
-               ranges::views::transform([](auto Pair) {
-                 auto &[Fold, Expanded] = Pair;
-                 return Copy(Fold) |
-                        ranges::actions::push_back(ranges::tuple_apply(
-                            Construct<FlatPathEdge>, Expanded));
-               }) |
-               ranges::to_vector;
-      });
+  if (Exhausted_) {
+    return std::nullopt;
+  }
+
+  auto FlatPath =
+      ranges::views::zip(EdgeAlternatives_, AlternativeIndices_) |
+      ranges::views::transform([](const auto &AlternativesAndIndex) {
+        const auto &[Alternatives, AlternativeIndex] = AlternativesAndIndex;
+        return Alternatives[AlternativeIndex];
+      }) |
+      ranges::to_vector;
+  advance();
+  return FlatPath;
+}
+
+void FlatPathGenerator::advance() {
+  // count up the indices like the digits of a number, with the number of
+  // alternatives of an edge as the base of its digit. The last edge changes
+  // fastest, like in a cartesian product.
+  auto Position = AlternativeIndices_.size();
+  while (Position != 0U) {
+    --Position;
+    if (++AlternativeIndices_[Position] < EdgeAlternatives_[Position].size()) {
+      return;
+    }
+    AlternativeIndices_[Position] = 0U;
+  }
+  Exhausted_ = true;
+}
+
+bool FlatPathGenerator::takesDistinctTransitions() const {
+  auto TakenTransitions =
+      ranges::views::zip(EdgeAlternativeTransitions_, AlternativeIndices_) |
+      ranges::views::transform([](const auto &AlternativesAndIndex) {
+        const auto &[Transitions, AlternativeIndex] = AlternativesAndIndex;
+        return Transitions[AlternativeIndex];
+      }) |
+      ranges::to_vector | ranges::actions::sort;
+  return ranges::adjacent_find(TakenTransitions) == TakenTransitions.end();
+}
+
+ExpansionCache::ExpansionCache(std::shared_ptr<TransitionData> Transitions)
+    : Transitions_{std::move(Transitions)},
+      TransitionsByType_{buildTransitionsByTypeIndex(*Transitions_, {})} {}
+
+std::vector<InternedTransitionType>
+ExpansionCache::getTransitionsForVertex(const TypeIdSet &Vertex) {
+  auto Cached = std::optional<std::vector<InternedTransitionType>>{};
+  TransitionsByVertex_.cvisit(Vertex, [&Cached](const auto &Entry) {
+    Cached = Entry.second;
+  });
+  if (Cached) {
+    return *std::move(Cached);
+  }
+  auto Transitions =
+      lookupTransitionsForVertex(*Transitions_, TransitionsByType_, Vertex);
+  TransitionsByVertex_.emplace(Vertex, Transitions);
+  return Transitions;
 }
 
 class GraphBuilder::GraphBuilderImpl {
 public:
+  GraphBuilderImpl(TransitionData *Transitions,
+                   std::vector<TypeIdSet> Queries,
+                   std::shared_ptr<ExpansionCache> Cache)
+      : Transitions{Transitions},
+        Queries{std::move(Queries)},
+        TransitionsByType{Cache ? TransitionsByTypeIndex{}
+                                : buildTransitionsByTypeIndex(*Transitions,
+                                                              this->Queries)},
+        Cache{std::move(Cache)} {}
+
+  // the transitions of the queries that acquire a type of the vertex
+  [[nodiscard]] std::vector<InternedTransitionType>
+  getTransitionsForVertex(const GraphBuilder::VertexType &Vertex) const {
+    if (!Cache) {
+      return lookupTransitionsForVertex(*Transitions, TransitionsByType,
+                                        Vertex);
+    }
+    return getTransitionsForQuery(
+        *Transitions, Cache->getTransitionsForVertex(Vertex), Queries);
+  }
+
   [[nodiscard]] auto toTransitionAndTargetTypeSetPairForVertex(
-      const indexed_value<GraphBuilder::VertexType> &IndexedVertex) {
-    return [&IndexedVertex, this](const TransitionType &Transition) {
+      const IndexedVertexType &IndexedVertex) const {
+    return [&IndexedVertex, this](const InternedTransitionType &Transition) {
       const auto Acquired = ToAcquired(Transition);
-      const auto ConversionsOfAcquired =
-          Transitions->ConversionMap.find(Acquired.Desugared);
-
-      GetMeException::verify(
-          ConversionsOfAcquired != Transitions->ConversionMap.end(),
-          "Could not find type conversion mapping for {}", Acquired);
-
-      const auto NewRequired =
-          Value(IndexedVertex) |
-          ranges::views::set_difference(ConversionsOfAcquired->second) |
-          ranges::views::set_union(ToRequired(Transition)) |
-          ranges::to<TypeSet>;
-      return std::pair{Transition, NewRequired};
+      const auto &ConversionsOfAcquired =
+          Transitions->InternedConversions[Acquired];
+
+      GetMeException::verify(!ConversionsOfAcquired.empty(),
+                             "Could not find type conversion mapping for {}",
+                             Transitions->Types[Acquired]);
+
+      return std::pair{Transition,
+                       setDifferenceAndUnion(Value(IndexedVertex),
+                                             ConversionsOfAcquired,
+                                             ToRequired(Transition))};
+    };
+  }
+
+  // only reads the transitions, safe to call concurrently
+  [[nodiscard]] TransitionAndTargetVector
+  expandVertex(const IndexedVertexType &IndexedVertex,
+               const size_t IterationIndex, const Config &Conf) const {
+    const auto MaxAllowedTypeSetSize =
+        SafePlus(Conf.MaxPathLength, Conf.MaxRemainingTypes);
+    // adjust with -1 to correctly model removing the acquired in
+    // 'new = old-acquired+required'
+    const auto CurrentTypeSetSize =
+        SafePlus(ranges::size(Value(IndexedVertex)), IterationIndex) - 1;
+    // without remaining types, a target is only useful if all of its types can
+    // be acquired in the remaining graph building steps
+    const auto MaxAllowedAcquisitionCost =
+        Conf.MaxRemainingTypes == 0U ? Conf.MaxGraphDepth - IterationIndex
+                                     : UnreachableAcquisitionCost;
+
+    return getSmallestIndependentTransitions(
+               getTransitionsForVertex(Value(IndexedVertex))) |
+           ranges::views::filter(
+               LessEqual(MaxAllowedTypeSetSize),
+               ranges::compose(ranges::bind_back(SafePlus, CurrentTypeSetSize),
+                               ranges::compose(ranges::size, ToRequired))) |
+           ranges::views::transform(
+               toTransitionAndTargetTypeSetPairForVertex(IndexedVertex)) |
+           ranges::to_vector |
+           ranges::actions::remove_if(
+               [this, MaxAllowedAcquisitionCost](
+                   const std::pair<InternedTransitionType, TypeIdSet>
+                       &TransitionAndTarget) {
+                 return MaxAllowedAcquisitionCost !=
+                            UnreachableAcquisitionCost &&
+                        Transitions->getAcquisitionCost(
+                            Value(TransitionAndTarget)) >
+                            MaxAllowedAcquisitionCost;
+               });
+  }
+
+  // expands the vertices independently of each other, in parallel if
+  // enabled. The expansions keep the order of the vertices, merging them in
+  // that order produces the same graph as a sequential build. Vertices that
+  // are reached after Deadline are not expanded.
+  [[nodiscard]] VertexExpansionVector
+  expandVertices(std::vector<IndexedVertexType> Vertices,
+                 const size_t IterationIndex, const Config &Conf,
+                 const std::chrono::steady_clock::time_point Deadline) const {
+    auto Expansions =
+        ranges::views::zip(Vertices | ranges::views::move,
+                           ranges::views::repeat(TransitionAndTargetVector{})) |
+        ranges::to<VertexExpansionVector>;
+    const auto Expand = [this, &Expansions, IterationIndex, &Conf,
+                         Deadline](const size_t ExpansionIndex) {
+      if (std::chrono::steady_clock::now() >= Deadline) {
+        return;
+      }
+      auto &[IndexedVertex, TransitionsAndTargets] = Expansions[ExpansionIndex];
+      TransitionsAndTargets = expandVertex(IndexedVertex, IterationIndex, Conf);
     };
+
+    if (Conf.EnableParallelGraphBuilding) {
+      tbb::parallel_for(size_t{0U}, Expansions.size(), Expand);
+    } else {
+      ranges::for_each(ranges::views::indices(Expansions.size()), Expand);
+    }
+    return Expansions;
   }
 
   TransitionData *Transitions;
+  std::vector<TypeIdSet> Queries;
+  // empty when the transitions are looked up in the shared Cache
+  TransitionsByTypeIndex TransitionsByType;
+  std::shared_ptr<ExpansionCache> Cache;
 };
 
 GraphBuilder::GraphBuilder(std::shared_ptr<TransitionData> Transitions,
-                           TypeSet Query, std::shared_ptr<Config> Conf)
+                           TypeSet Query, std::shared_ptr<Config> Conf,
+                           std::shared_ptr<ExpansionCache> Cache)
+    : GraphBuilder{std::move(Transitions), std::vector{std::move(Query)},
+                   std::move(Conf), std::move(Cache)} {}
+
+GraphBuilder::GraphBuilder(std::shared_ptr<TransitionData> Transitions,
+                           const std::vector<TypeSet> &Queries,
+                           std::shared_ptr<Config> Conf,
+                           std::shared_ptr<ExpansionCache> Cache)
     : Transitions_{std::move(Transitions)},
-      Query_{std::move(Query)},
-      EmptyTsIndex_{ranges::size(Query_)},
       VertexData_{ranges::views::concat(
-                      ranges::views::enumerate(Query_) |
-                          ranges::views::transform(
-                              [](const auto Pair) -> VertexSet::value_type {
-                                return {std::get<0>(Pair), {std::get<1>(Pair)}};
-                              }),
-                      ranges::views::single(VertexSet::value_type{
-                          ranges::size(Query_), TypeSet{}})) |
-                  ranges::to<VertexSet>},
+                      getQueryVertices(*Transitions_, Queries),
+                      ranges::views::single(VertexType{})) |
+                  ranges::to_vector},
+      EmptyTsIndex_{VertexData_.size() - 1U},
+      VertexIndices_{ranges::views::enumerate(VertexData_) |
+                     ranges::views::transform([](const auto Pair) {
+                       return std::pair{std::get<1>(Pair),
+                                        VertexDescriptor{std::get<0>(Pair)}};
+                     }) |
+                     ranges::to<VertexIndexMap>},
       VertexDepth_{
           ranges::views::concat(
-              ranges::views::repeat_n(
-                  size_t{0U}, static_cast<std::int64_t>(ranges::size(Query_))),
+              ranges::views::repeat_n(size_t{0U},
+                                      static_cast<std::int64_t>(EmptyTsIndex_)),
               ranges::views::single(size_t{1U})) |
           ranges::to_vector},
-      Conf_{std::move(Conf)},
-      CurrentState_{0U, VertexData_},
-      Impl_{std::make_unique<GraphBuilderImpl>(Transitions_.get())} {}
+      Conf_{scaleConfigForQueries(std::move(Conf), Queries.size())},
+      CurrentState_{0U, ranges::views::indices(VertexData_.size()) |
+                            ranges::to<VertexSet>},
+      Impl_{std::make_unique<GraphBuilderImpl>(
+          Transitions_.get(),
+          Queries |
+              ranges::views::transform(
+                  [this](const TypeSet &Query) {
+                    return Transitions_->getTypeIds(Query);
+                  }) |
+              ranges::to_vector,
+          std::move(Cache))} {
+  if (Conf_->EnableDominancePruning) {
+    ranges::for_each(VertexData_, [this](const VertexType &Vertex) {
+      DominatingVertices_.insert(Vertex);
+    });
+  }
+}
 
-void GraphBuilder::build() {
-  while (CurrentState_.IterationIndex < Conf_->MaxGraphDepth && buildStep()) {
-    // complete build
+void GraphBuilder::build(const std::chrono::steady_clock::time_point Deadline) {
+  Deadline_ = Deadline;
+  while (CurrentState_.IterationIndex < Conf_->MaxGraphDepth) {
+    if (std::chrono::steady_clock::now() >= Deadline) {
+      Truncated_ = true;
+      return;
+    }
+    if (!buildStep()) {
+      return;
+    }
   }
 }
 
@@ -241,19 +633,30 @@ bool GraphBuilder::buildStep() {
 }
 
 bool GraphBuilder::buildStepFor(const VertexDescriptor Vertex) {
-  return buildStepFor(VertexData_ |
-                      ranges::views::filter(EqualTo(Vertex), Index) |
-                      ranges::to<VertexSet>);
+  if (Vertex >= VertexData_.size()) {
+    return buildStepFor(VertexSet{});
+  }
+  return buildStepFor(VertexSet{Vertex});
 }
 
 bool GraphBuilder::buildStepFor(const VertexType &InterestingVertex) {
-  return buildStepFor(
-      ranges::subrange{VertexData_.lower_bound(InterestingVertex),
-                       VertexData_.upper_bound(InterestingVertex)} |
-      ranges::to<VertexSet>);
+  const auto Iter = VertexIndices_.find(InterestingVertex);
+  if (Iter == VertexIndices_.end()) {
+    return buildStepFor(VertexSet{});
+  }
+  return buildStepFor(VertexSet{Iter->second});
 }
 
 bool GraphBuilder::buildStepFor(VertexSet InterestingVertices) {
+  // copy the type sets, VertexData_ grows while the vertices are expanded.
+  // Expand the vertices ordered by their type set, like before hashing
+  // vertices, to keep the assigned vertex descriptors stable.
+  auto IndexedInterestingVertices =
+      InterestingVertices |
+      ranges::views::transform([this](const VertexDescriptor Vertex) {
+        return IndexedVertexType{Vertex, VertexData_[Vertex]};
+      }) |
+      ranges::to_vector | ranges::actions::sort(IndexedSetComparator{});
   CurrentState_.InterestingVertices.clear();
   ++CurrentState_.IterationIndex;
 
@@ -263,18 +666,19 @@ bool GraphBuilder::buildStepFor(VertexSet InterestingVertices) {
       SafePlus(Conf_->MaxRemainingTypes, NumGraphBuildingStepsLeft);
 
   auto MaybeAddEdgeFrom = [this, MaxAllowedSizeOfTargetVertex](
-                              const indexed_value<VertexType>
-                                  &IndexedSourceVertex) {
+                              const IndexedVertexType &IndexedSourceVertex) {
     const auto SourceDepth = VertexDepth_[Index(IndexedSourceVertex)];
     return
         [this, &IndexedSourceVertex, SourceDepth, MaxAllowedSizeOfTargetVertex](
             bool AddedTransitions,
-            const std::pair<TransitionType, TypeSet> &TransitionAndTargetTS) {
+            const std::pair<InternedTransitionType, VertexType>
+                &TransitionAndTargetTS) {
           const auto &[Transition, TargetTypeSet] = TransitionAndTargetTS;
-          const auto TargetVertexIter = VertexData_.find(TargetTypeSet);
-          const auto TargetVertexExists = TargetVertexIter != VertexData_.end();
+          const auto TargetVertexIter = VertexIndices_.find(TargetTypeSet);
+          const auto TargetVertexExists =
+              TargetVertexIter != VertexIndices_.end();
           const auto TargetVertexIndex = TargetVertexExists
-                                             ? Index(*TargetVertexIter)
+                                             ? TargetVertexIter->second
                                              : VertexData_.size();
 
           const auto EdgeToAdd = TransitionEdgeType{
@@ -284,6 +688,19 @@ bool GraphBuilder::buildStepFor(VertexSet InterestingVertices) {
             return AddedTransitions;
           }
 
+          // the vertices are added by increasing depth, every vertex in the
+          // index has at most the depth of the target
+          if (!TargetVertexExists && Conf_->EnableDominancePruning &&
+              DominatingVertices_.containsStrictSubsetOf(TargetTypeSet)) {
+            return AddedTransitions;
+          }
+
+          if (!TargetVertexExists &&
+              VertexData_.size() >= Conf_->MaxGraphVertices) {
+            Truncated_ = true;
+            return AddedTransitions;
+          }
+
           if (TargetVertexExists) {
             if (!isEmptyTargetTS(TargetVertexIndex) &&
                 !Conf_->EnableGraphBackwardsEdge &&
@@ -291,16 +708,18 @@ bool GraphBuilder::buildStepFor(VertexSet InterestingVertices) {
               return AddedTransitions;
             }
 
-            if (edgeWithTransitionExistsInContainer(Edges_, EdgeToAdd,
-                                                    Transition)) {
+            if (edgeWithTransitionExistsInContainer(Edges_, EdgeToAdd)) {
               return AddedTransitions;
             }
           }
-          CurrentState_.InterestingVertices.emplace(TargetVertexIndex,
-                                                    TargetTypeSet);
+          CurrentState_.InterestingVertices.emplace(TargetVertexIndex);
           if (!TargetVertexExists) {
-            VertexData_.emplace(TargetVertexIndex, TargetTypeSet);
+            VertexIndices_.emplace(TargetTypeSet, TargetVertexIndex);
+            VertexData_.push_back(TargetTypeSet);
             VertexDepth_.push_back(CurrentState_.IterationIndex);
+            if (Conf_->EnableDominancePruning) {
+              DominatingVertices_.insert(TargetTypeSet);
+            }
           }
           if (const auto [_, EdgeAdded] = Edges_.emplace(EdgeToAdd);
               EdgeAdded) {
@@ -311,59 +730,63 @@ bool GraphBuilder::buildStepFor(VertexSet InterestingVertices) {
         };
   };
 
-  auto TransitionsForQuery = getTransitionsForQuery(Transitions_->Data, Query_);
-  auto VertexAndTransitionsVec = constructVertexAndTransitionsPairVector(
-      std::move(InterestingVertices), TransitionsForQuery,
-      Transitions_->ConversionMap);
+  const auto Expansions =
+      Impl_->expandVertices(std::move(IndexedInterestingVertices),
+                            CurrentState_.IterationIndex, *Conf_, Deadline_);
+  // the clock is monotonic, a vertex that was not expanded was reached after
+  // the deadline
+  if (std::chrono::steady_clock::now() >= Deadline_) {
+    Truncated_ = true;
+  }
   return ranges::fold_left(
-      VertexAndTransitionsVec, false,
-      [this, MaybeAddEdgeFrom](bool AddedTransitions,
-                               const auto &VertexAndTransitions) {
-        const auto &[IndexedVertex, Transitions] = VertexAndTransitions;
-
-        const auto MaxAllowedTypeSetSize =
-            SafePlus(Conf_->MaxPathLength, Conf_->MaxRemainingTypes);
-        // adjust with -1 to correctly model removing the acquired in
-        // 'new = old-acquired+required'
-        const auto CurrentTypeSetSize =
-            SafePlus(ranges::size(Value(IndexedVertex)),
-                     CurrentState_.IterationIndex) -
-            1;
-
-        return ranges::fold_left(
-            Transitions |
-                ranges::views::filter(
-                    LessEqual(MaxAllowedTypeSetSize),
-                    ranges::compose(
-                        ranges::bind_back(SafePlus, CurrentTypeSetSize),
-                        ranges::compose(ranges::size, ToRequired))) |
-                ranges::views::transform(
-                    Impl_->toTransitionAndTargetTypeSetPairForVertex(
-                        IndexedVertex)),
-            AddedTransitions, MaybeAddEdgeFrom(IndexedVertex));
+      Expansions, false,
+      [MaybeAddEdgeFrom](bool AddedTransitions, const auto &Expansion) {
+        const auto &[IndexedVertex, TransitionsAndTargets] = Expansion;
+        return ranges::fold_left(TransitionsAndTargets, AddedTransitions,
+                                 MaybeAddEdgeFrom(IndexedVertex));
       });
 }
 
 GraphData GraphBuilder::commit() {
-  return {getIndexedSetSortedByIndex(std::move(VertexData_)),
+  return {VertexData_ |
+              ranges::views::transform([this](const VertexType &Vertex) {
+                return Transitions_->getTypes(Vertex);
+              }) |
+              ranges::to_vector,
           std::move(VertexDepth_), Edges_, Transitions_, std::move(Conf_)};
 }
 
 GraphData runGraphBuilding(const std::shared_ptr<TransitionData> &Transitions,
-                           const TypeSet &Query, std::shared_ptr<Config> Conf) {
-  auto Builder = GraphBuilder{Transitions, Query, std::move(Conf)};
+                           const TypeSet &Query, std::shared_ptr<Config> Conf,
+                           std::shared_ptr<ExpansionCache> Cache) {
+  auto Builder =
+      GraphBuilder{Transitions, Query, std::move(Conf), std::move(Cache)};
+  Builder.build();
+  return Builder.commit();
+}
+
+GraphData runGraphBuilding(const std::shared_ptr<TransitionData> &Transitions,
+                           const std::vector<TypeSet> &Queries,
+                           std::shared_ptr<Config> Conf,
+                           std::shared_ptr<ExpansionCache> Cache) {
+  auto Builder =
+      GraphBuilder{Transitions, Queries, std::move(Conf), std::move(Cache)};
   Builder.build();
   return Builder.commit();
 }
 
 std::string fmt::formatter<GraphData>::toDotFormat(const GraphData &Data) {
   const auto ToString = [&Data](const TransitionEdgeType &Edge) {
-    const auto Transition =
-        ToTransitions(Data.Transitions->BundeledData[Edge.TransitionIndex]);
+    const auto Transitions =
+        Data.getEdgeTransitions(Edge) |
+        ranges::views::for_each([&Data](const size_t TransitionIndex) {
+          return ToTransitions(Data.Transitions->getBundle(TransitionIndex));
+        });
     const auto TargetVertex = Target(Edge);
     const auto SourceVertex = Source(Edge);
 
-    auto EdgeWeightAsString = fmt::format("{}", fmt::join(Transition, ",\n"));
+    auto EdgeWeightAsString =
+        fmt::format("{}", fmt::join(Transitions, ",\n"));
     boost::replace_all(EdgeWeightAsString, "\"", "\\\"");
     return fmt::format(R"(  {} -> {}[label="{}"])", SourceVertex, TargetVertex,
                        EdgeWeightAsString);
@@ -421,3 +844,130 @@ std::vector<VertexDescriptor> getRootVertices(const GraphData &Data) {
 std::vector<VertexDescriptor> getLeafVertices(const GraphData &Data) {
   return getVerticesThatAreNotA(Data, Source);
 }
+
+namespace {
+// the edge between the vertices of Edge, the graph has at most one
+[[nodiscard]] std::optional<TransitionEdgeType>
+findEdge(const GraphData &Data, const EdgeType &Edge) {
+  const auto Iter = ranges::lower_bound(Data.Edges, Edge, std::less{},
+                                        &TransitionEdgeType::Edge);
+  if (Iter == Data.Edges.end() || Iter->Edge != Edge) {
+    return std::nullopt;
+  }
+  return *Iter;
+}
+
+[[nodiscard]] bool haveSameTransitions(const GraphData &Data,
+                                       const TransitionEdgeType &Lhs,
+                                       const TransitionEdgeType &Rhs) {
+  return Lhs.TransitionIndex == Rhs.TransitionIndex &&
+         ranges::equal(Data.getEdgeTransitions(Lhs),
+                       Data.getEdgeTransitions(Rhs));
+}
+
+// assigns every edge of a path a different transition bundle out of its
+// alternatives, a bipartite matching found with augmenting paths
+class TransitionMatching {
+public:
+  explicit TransitionMatching(
+      std::vector<std::span<const size_t>> EdgeAlternatives)
+      : EdgeAlternatives_{std::move(EdgeAlternatives)} {}
+
+  [[nodiscard]] bool matchAll() {
+    return ranges::all_of(ranges::views::indices(EdgeAlternatives_.size()),
+                          [this](const size_t EdgeIndex) {
+                            Visited_.clear();
+                            return match(EdgeIndex);
+                          });
+  }
+
+private:
+  [[nodiscard]] bool match(const size_t EdgeIndex) {
+    return ranges::any_of(
+        EdgeAlternatives_[EdgeIndex],
+        [this, EdgeIndex](const size_t Transition) {
+          if (!Visited_.insert(Transition).second) {
+            return false;
+          }
+          // the edge that took Transition has to take another bundle
+          if (const auto Matched = MatchedEdges_.find(Transition);
+              Matched != MatchedEdges_.end() && !match(Matched->second)) {
+            return false;
+          }
+          MatchedEdges_.insert_or_assign(Transition, EdgeIndex);
+          return true;
+        });
+  }
+
+  std::vector<std::span<const size_t>> EdgeAlternatives_;
+  // the edge that takes a transition bundle
+  boost::unordered_flat_map<size_t, size_t> MatchedEdges_;
+  boost::unordered_flat_set<size_t> Visited_;
+};
+} // namespace
+
+std::vector<VertexDescriptor>
+getSwappedOrderVertices(const GraphData &Data, const TransitionEdgeType &First,
+                        const TransitionEdgeType &Second) {
+  // the transition index of an edge is the lowest index of its bundles, the
+  // swapped path takes the same bundles and is in canonical order
+  if (First.TransitionIndex <= Second.TransitionIndex) {
+    return {};
+  }
+  return ranges::equal_range(Data.Edges, Source(First), std::less{}, Source) |
+         ranges::views::filter([&Data, &First, &Second](
+                                   const TransitionEdgeType &SwappedSecond) {
+           if (!haveSameTransitions(Data, SwappedSecond, Second)) {
+             return false;
+           }
+           const auto SwappedFirst =
+               findEdge(Data, {Target(SwappedSecond), Target(Second)});
+           return SwappedFirst.has_value() &&
+                  haveSameTransitions(Data, *SwappedFirst, First);
+         }) |
+         ranges::views::transform(Target) | ranges::to_vector;
+}
+
+bool canSwapOrderThrough(const GraphData &Data, const PathType &Known,
+                         const TransitionEdgeType &First,
+                         const TransitionEdgeType &Second,
+                         const VertexDescriptor Swapped) {
+  // the unknown edges before First can only reach Swapped from the component
+  // of the source of First, the unknown edges after Second only from the
+  // component of the target of Second
+  const auto Component = Data.VertexComponents[Swapped];
+  if (Component == Data.VertexComponents[Source(First)] ||
+      Component == Data.VertexComponents[Target(Second)]) {
+    return false;
+  }
+  return !ranges::contains(Known, Swapped, Source) &&
+         !(Data.Conf->EnableGraphBackwardsEdge &&
+           ranges::contains(Known, Swapped, Target));
+}
+
+bool canTakeDistinctTransitions(const GraphData &Data, const PathType &Path,
+                                const TransitionEdgeType &Edge) {
+  const auto Transitions = Data.getEdgeTransitions(Edge);
+  const auto SharesTransition =
+      [&Data, &Transitions](const TransitionEdgeType &EdgeInPath) {
+        return ranges::any_of(Data.getEdgeTransitions(EdgeInPath),
+                              [&Transitions](const size_t Transition) {
+                                return ranges::binary_search(Transitions,
+                                                             Transition);
+                              });
+      };
+  // the edges of Path already take different bundles, only the edges that
+  // share a bundle with Edge may have to take another one
+  if (ranges::none_of(Path, SharesTransition)) {
+    return true;
+  }
+  return TransitionMatching{
+      ranges::views::concat(
+          Path | ranges::views::transform(
+                     [&Data](const TransitionEdgeType &EdgeInPath) {
+                       return Data.getEdgeTransitions(EdgeInPath);
+                     }),
+          ranges::views::single(Transitions)) |
+      ranges::to_vector}
+      .matchAll();
+}
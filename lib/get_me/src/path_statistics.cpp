@@ -0,0 +1,29 @@
+#include "get_me/path_statistics.hpp"
+
+#include <cstddef>
+#include <vector>
+
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/iterator/operations.hpp>
+
+#include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "support/ranges/functional.hpp"
+
+PathStatistics getPathStatistics(const GraphData &Data) {
+  const auto NumLengths = SafePlus(Data.Conf->MaxPathLength, size_t{1U});
+  auto Statistics = PathStatistics{std::vector<size_t>(NumLengths),
+                                   std::vector<size_t>(NumLengths)};
+  ranges::for_each(generatePaths(Data), [&Data,
+                                         &Statistics](const PathType &Path) {
+    auto &PathCount = Statistics.PathCounts[Path.size()];
+    PathCount = SafePlus(PathCount, size_t{1U});
+    auto &ExpandedPathCount = Statistics.ExpandedPathCounts[Path.size()];
+    ExpandedPathCount =
+        SafePlus(ExpandedPathCount,
+                 static_cast<size_t>(
+                     ranges::distance(generateFlatPaths(Path, Data))));
+  });
+  return Statistics;
+}
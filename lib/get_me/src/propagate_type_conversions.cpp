@@ -43,22 +43,41 @@ namespace {
   const auto HandleDefault = [](const auto &T) -> Type { return T; };
   return std::visit(Overloaded{HandleQualType, HandleDefault}, SourceType);
 }
+
+[[nodiscard]] Type removeLocalConst(const Type &SourceType) {
+  const auto HandleQualType = [](clang::QualType QType) -> Type {
+    QType.removeLocalConst();
+    return QType;
+  };
+  const auto HandleDefault = [](const auto &T) -> Type { return T; };
+  return std::visit(Overloaded{HandleQualType, HandleDefault}, SourceType);
+}
+
 [[nodiscard]] TransparentType
-stripPointerRef(const TransparentType &SourceType) {
-  return {.Desugared = stripPointerRef(SourceType.Desugared),
-          .Actual = stripPointerRef(SourceType.Actual)};
+transformTypes(const TransparentType &SourceType,
+               const std::function<Type(const Type &)> &Transform) {
+  return {.Desugared = Transform(SourceType.Desugared),
+          .Actual = Transform(SourceType.Actual)};
 }
 } // namespace
 
-void propagateTypeConversions(TransitionData &Transitions) {
+TypeConversionOperations getQualTypeConversionOperations() {
+  return {.StripPointerRef = stripPointerRef,
+          .RemoveLocalConst = removeLocalConst};
+}
+
+void propagateTypeConversions(TransitionData &Transitions,
+                              const TypeConversionOperations &Operations) {
   const auto AllTypes =
       ranges::views::concat(
           Transitions.Data | ranges::views::transform(ToAcquired),
           Transitions.Data | ranges::views::for_each(ToRequired)) |
       ranges::to_vector;
   const auto FlatPointerRefConversions =
-      AllTypes | ranges::views::transform([](const TransparentType &Type) {
-        return std::pair{stripPointerRef(Type), Type};
+      AllTypes |
+      ranges::views::transform([&Operations](const TransparentType &Type) {
+        return std::pair{transformTypes(Type, Operations.StripPointerRef),
+                         Type};
       }) |
       ranges::to_vector | ranges::actions::sort(std::less<>{}, Element<0>);
 
@@ -102,27 +121,23 @@ void propagateTypeConversions(TransitionData &Transitions) {
               }) |
               ranges::to<TypeConversionMap>);
 
-  ranges::for_each(ConversionMap | ranges::views::values, [&ConversionMap](
-                                                              TypeSet &Val) {
-    Val.merge(Val | ranges::views::transform([](TransparentType TType) {
-                const auto RemoveConst = Overloaded{
-                    [](clang::QualType &QType) { QType.removeLocalConst(); },
-                    [](const auto &) {}};
-
-                std::visit(RemoveConst, TType.Desugared);
-                std::visit(RemoveConst, TType.Actual);
-                return TType;
-              }) |
-              ranges::to<TypeSet>);
+  const auto RemoveLocalConst = [&Operations](const TransparentType &TType) {
+    return transformTypes(TType, Operations.RemoveLocalConst);
+  };
+  ranges::for_each(
+      ConversionMap | ranges::views::values,
+      [&ConversionMap, &RemoveLocalConst](TypeSet &Val) {
+        Val.merge(Val | ranges::views::transform(RemoveLocalConst) |
+                  ranges::to<TypeSet>);
 
-    Val.merge(
-        Val |
-        ranges::views::transform(
-            [&ConversionMap](const TypeSet::value_type &Type) {
-              return ConversionMap.find(Type.Desugared);
-            }) |
-        ranges::views::filter(ranges::not_fn(EqualTo(ConversionMap.end()))) |
-        ranges::views::indirect | ranges::views::values | ranges::views::join |
-        ranges::to<TypeSet>);
-  });
+        Val.merge(Val |
+                  ranges::views::transform(
+                      [&ConversionMap](const TypeSet::value_type &Type) {
+                        return ConversionMap.find(Type.Desugared);
+                      }) |
+                  ranges::views::filter(
+                      ranges::not_fn(EqualTo(ConversionMap.end()))) |
+                  ranges::views::indirect | ranges::views::values |
+                  ranges::views::join | ranges::to<TypeSet>);
+      });
 }
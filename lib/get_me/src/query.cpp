@@ -1,79 +1,138 @@
 #include "get_me/query.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
 #include <string_view>
-#include <variant>
+#include <utility>
+#include <vector>
 
-#include <clang/AST/Type.h>
+#include <boost/algorithm/string/trim.hpp>
 #include <fmt/core.h>
 #include <fmt/ranges.h> // IWYU pragma: keep
+#include <range/v3/algorithm/all_of.hpp>
 #include <range/v3/algorithm/any_of.hpp>
-#include <range/v3/algorithm/find_if.hpp>
-#include <range/v3/functional/bind_back.hpp>
-#include <range/v3/functional/not_fn.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/algorithm/none_of.hpp>
 #include <range/v3/range/conversion.hpp>
-#include <range/v3/view/filter.hpp>
-#include <spdlog/spdlog.h>
+#include <range/v3/view/remove_if.hpp>
+#include <range/v3/view/transform.hpp>
 
 #include "get_me/transitions.hpp"
+#include "get_me/type_name_index.hpp"
 #include "get_me/type_set.hpp"
 #include "support/get_me_exception.hpp"
-#include "support/ranges/functional.hpp"
-#include "support/variant.hpp"
 
 namespace {
-[[nodiscard]] bool
-matchesQueriedTypeName(const TransparentType &Val,
-                       const std::string_view QueriedTypeAsString) {
-  const auto MatchesName = Overloaded{
-      [QueriedTypeAsString](const clang::QualType &QType) {
-        const auto TypeAsString = fmt::format("{}", QType);
-        const auto EquivalentName = TypeAsString == QueriedTypeAsString;
-        if (!EquivalentName &&
-            (TypeAsString.find(QueriedTypeAsString) != std::string::npos)) {
-          spdlog::trace("matchesQueriedTypeName: no match for "
-                        "close match: {} != {}",
-                        TypeAsString, QueriedTypeAsString);
-        }
-        return EquivalentName;
-      },
-      [QueriedTypeAsString](const ArithmeticType &) {
-        return QueriedTypeAsString == fmt::format("{}", ArithmeticType{});
-      }};
-  return std::visit(MatchesName, Val.Actual);
-}
+// the number of similar type names listed when a queried name has no match
+constexpr std::size_t MaxSuggestedTypeNames = 10U;
 } // namespace
 
 TypeSet getQueriedTypesForInput(const TransitionData &Transitions,
                                 const std::string_view QueriedTypeAsString) {
-  const auto QueriedTypesIter = ranges::find_if(
-      Transitions.ConversionMap,
-      ranges::bind_back(ranges::any_of,
-                        [QueriedTypeAsString](const TransparentType &Type) {
-                          return matchesQueriedTypeName(Type,
-                                                        QueriedTypeAsString);
-                        }),
-      Value);
-
-  GetMeException::verify(QueriedTypesIter != Transitions.ConversionMap.end(),
-                         "getQueriedTypeForInput(): no type matching {} in {}",
-                         QueriedTypeAsString, Transitions.ConversionMap);
+  const auto QueriedType = Transitions.NameIndex.find(QueriedTypeAsString);
+  GetMeException::verify(
+      QueriedType.has_value(),
+      "getQueriedTypeForInput(): no type matching {}, similar types: {}",
+      QueriedTypeAsString,
+      Transitions.NameIndex.findPartialMatches(QueriedTypeAsString,
+                                               MaxSuggestedTypeNames));
 
-  return QueriedTypesIter->second;
+  return Transitions.ConversionMap.at(*QueriedType);
 }
 
-TransitionData::associative_container_type getTransitionsForQuery(
-    const TransitionData::associative_container_type &Transitions,
-    const TypeSet &Query) {
-  const auto QueriedTypeIsSubset = [&Query](const auto &Required) {
-    return ranges::any_of(Query,
-                          [&Required](const TransparentType &QueriedType) {
-                            return Required.contains(QueriedType);
-                          });
+std::vector<std::string> splitTypeNames(const std::string_view TypeNames) {
+  auto Names = std::vector<std::string>{};
+  auto CurrentName = std::string{};
+  // the nesting depth of template arguments, parentheses and brackets
+  auto Depth = 0;
+  const auto AddName = [&Names](std::string Name) {
+    boost::algorithm::trim(Name);
+    if (!Name.empty()) {
+      Names.push_back(std::move(Name));
+    }
   };
 
-  return Transitions |
-         ranges::views::filter(ranges::not_fn(QueriedTypeIsSubset),
-                               ToRequired) |
-         ranges::to<TransitionData::associative_container_type>;
+  ranges::for_each(TypeNames, [&CurrentName, &Depth,
+                               &AddName](const char Character) {
+    switch (Character) {
+    case '<':
+    case '(':
+    case '[':
+      ++Depth;
+      break;
+    case '>':
+    case ')':
+    case ']':
+      Depth = std::max(Depth - 1, 0);
+      break;
+    case ',':
+      if (Depth == 0) {
+        AddName(std::exchange(CurrentName, {}));
+        return;
+      }
+      break;
+    default:
+      break;
+    }
+    CurrentName += Character;
+  });
+  AddName(std::move(CurrentName));
+  return Names;
+}
+
+std::vector<TypeSet>
+getQueriedTypesForInputs(const TransitionData &Transitions,
+                         const std::vector<std::string> &QueriedTypeNames) {
+  GetMeException::verify(!QueriedTypeNames.empty(),
+                         "getQueriedTypesForInputs(): no type to query");
+  return QueriedTypeNames |
+         ranges::views::transform(
+             [&Transitions](const std::string &QueriedTypeName) {
+               return getQueriedTypesForInput(Transitions, QueriedTypeName);
+             }) |
+         ranges::to_vector;
+}
+
+TypeSet getQueriedTypesForType(const TransitionData &Transitions,
+                               const TransparentType &QueriedType) {
+  // the conversions of a type are interned by its id, a transition acquiring
+  // QueriedType provides exactly these types
+  const auto &Conversions =
+      Transitions.InternedConversions[Transitions.getTypeId(QueriedType)];
+
+  GetMeException::verify(!Conversions.empty(),
+                         "getQueriedTypesForType(): no conversions of {}",
+                         QueriedType);
+
+  return Transitions.getTypes(Conversions);
+}
+
+std::vector<InternedTransitionType>
+getTransitionsForQuery(const TransitionData &Data,
+                       const std::vector<InternedTransitionType> &Transitions,
+                       const std::vector<TypeIdSet> &Queries) {
+  if (Queries.empty()) {
+    return Transitions;
+  }
+  const auto IsDropped = [&Data, &Queries](
+                             const InternedTransitionType &Transition) {
+    const auto &Provided = Data.InternedConversions[ToAcquired(Transition)];
+    const auto &Required = ToRequired(Transition);
+    const auto RequiresTypeOf = [&Required](const TypeIdSet &Query) {
+      return intersects(Query, Required);
+    };
+    const auto ProvidesTypeOf = [&Provided](const TypeIdSet &Query) {
+      return intersects(Query, Provided);
+    };
+    if (ranges::none_of(Queries, ProvidesTypeOf)) {
+      return ranges::all_of(Queries, RequiresTypeOf);
+    }
+    return ranges::any_of(Queries, [&RequiresTypeOf, &ProvidesTypeOf](
+                                       const TypeIdSet &Query) {
+      return RequiresTypeOf(Query) && ProvidesTypeOf(Query);
+    });
+  };
+  return Transitions | ranges::views::remove_if(IsDropped) |
+         ranges::to_vector;
 }
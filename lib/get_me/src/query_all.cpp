@@ -1,29 +1,208 @@
 #include "get_me/query_all.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
 #include <memory>
-#include <tuple>
+#include <string>
+#include <utility>
+#include <vector>
 
-#include <oneapi/tbb/parallel_for_each.h>
+#include <fmt/core.h>
+#include <fmt/ranges.h>
 #include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
+#include <range/v3/action/sort.hpp>
+#include <range/v3/action/stable_sort.hpp>
+#include <range/v3/action/unique.hpp>
+#include <range/v3/algorithm/fold_left.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/iterator/operations.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/indices.hpp>
+#include <range/v3/view/join.hpp>
 #include <range/v3/view/transform.hpp>
+#include <range/v3/view/unique.hpp>
 #include <spdlog/spdlog.h>
 
 #include "get_me/backwards_path_finding.hpp"
 #include "get_me/graph.hpp"
 #include "get_me/query.hpp"
+#include "get_me/query_report.hpp"
+#include "get_me/ranked_path_finding.hpp"
 #include "get_me/transitions.hpp"
+#include "get_me/type_id_set.hpp"
+#include "get_me/type_set.hpp"
+#include "support/ranges/functional.hpp"
+
+namespace {
+[[nodiscard]] std::chrono::microseconds
+getElapsedTime(const std::chrono::steady_clock::time_point Start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - Start);
+}
+} // namespace
+
+std::vector<TypeSet> getAllQueries(const TransitionData &Transitions) {
+  // the transitions are ordered by their acquired type, and types with the
+  // same conversions resolve to the same query
+  return Transitions.Data | ranges::views::transform(ToAcquired) |
+         ranges::views::unique |
+         ranges::views::transform(
+             [&Transitions](const TransparentType &Acquired) {
+               return getQueriedTypesForType(Transitions, Acquired);
+             }) |
+         ranges::to_vector | ranges::actions::sort | ranges::actions::unique;
+}
+
+std::vector<size_t> estimateQueryCosts(const TransitionData &Transitions,
+                                       const std::vector<TypeSet> &Queries) {
+  // the number of transitions that can provide each type
+  auto FanIn = std::vector<size_t>(Transitions.Types.size());
+  ranges::for_each(Transitions.InternedData,
+                   [&Transitions,
+                    &FanIn](const InternedTransitionType &Transition) {
+                     ranges::for_each(
+                         Transitions.InternedConversions[ToAcquired(
+                             Transition)],
+                         [&FanIn](const TypeId Provided) {
+                           ++FanIn[Provided];
+                         });
+                   });
+  return Queries |
+         ranges::views::transform([&Transitions, &FanIn](const TypeSet &Query) {
+           return ranges::fold_left(
+               Transitions.getTypeIds(Query) |
+                   ranges::views::transform(Lookup(FanIn)),
+               size_t{0U}, SafePlus);
+         }) |
+         ranges::to_vector;
+}
+
+QueryReport runQuery(const std::shared_ptr<TransitionData> &Transitions,
+                     const TypeSet &Query, std::shared_ptr<Config> Conf,
+                     std::shared_ptr<ExpansionCache> Cache,
+                     const QueryOptions Options) {
+  return runQuery(Transitions, std::vector{Query}, std::move(Conf),
+                  std::move(Cache), Options);
+}
+
+QueryReport runQuery(const std::shared_ptr<TransitionData> &Transitions,
+                     const std::vector<TypeSet> &Queries,
+                     std::shared_ptr<Config> Conf,
+                     std::shared_ptr<ExpansionCache> Cache,
+                     const QueryOptions Options) {
+  auto Report = QueryReport{};
+  Report.Query = Queries | ranges::views::join |
+                 ranges::views::transform([](const auto &Type) {
+                   return fmt::format("{}", Type);
+                 }) |
+                 ranges::to_vector;
+
+  auto Start = std::chrono::steady_clock::now();
+  const auto HasTimeBudget =
+      Conf->MaxQueryMilliseconds != std::numeric_limits<size_t>::max();
+  const auto Deadline =
+      HasTimeBudget
+          ? Start + std::chrono::milliseconds{Conf->MaxQueryMilliseconds}
+          : std::chrono::steady_clock::time_point::max();
+  const auto IsBeforeDeadline = [Deadline]() {
+    return std::chrono::steady_clock::now() < Deadline;
+  };
+
+  auto Builder =
+      GraphBuilder{Transitions, Queries, std::move(Conf), std::move(Cache)};
+  Builder.build(Deadline);
+  Report.Truncated = Builder.isTruncated();
+  const auto Data = Builder.commit();
+  Report.GraphBuildingTime = getElapsedTime(Start);
+  Report.VertexCount = Data.VertexData.size();
+  Report.EdgeCount = Data.Edges.size();
+
+  // the paths are counted one at a time as they are generated, without
+  // keeping them. The search checks the deadline before every edge it takes,
+  // also while it does not find any path.
+  Start = std::chrono::steady_clock::now();
+  if (Options.CountPaths) {
+    Report.PathCount =
+        static_cast<size_t>(ranges::distance(generatePaths(Data, Deadline)));
+    Report.Truncated = Report.Truncated || !IsBeforeDeadline();
+  }
+  Report.PathFindingTime = getElapsedTime(Start);
+
+  if (!Options.RankPaths) {
+    return Report;
+  }
+
+  Start = std::chrono::steady_clock::now();
+  Report.Paths =
+      formatPaths(runTopKPathFinding(Data, Data.Conf->MaxPathOutputCount,
+                                     Deadline),
+                  Data) |
+      ranges::to_vector;
+  Report.Truncated = Report.Truncated || !IsBeforeDeadline();
+  Report.RankingTime = getElapsedTime(Start);
+  return Report;
+}
+
+std::vector<TypeSet> getScheduledQueries(const TransitionData &Transitions) {
+  auto Queries = getAllQueries(Transitions);
+  const auto Costs = estimateQueryCosts(Transitions, Queries);
+  const auto Schedule =
+      ranges::views::indices(Queries.size()) | ranges::to_vector |
+      ranges::actions::stable_sort(std::greater<>{}, Lookup(Costs));
+  return Schedule |
+         ranges::views::transform([&Queries](const size_t QueryIndex) {
+           return std::move(Queries[QueryIndex]);
+         }) |
+         ranges::to_vector;
+}
 
 void queryAll(const std::shared_ptr<TransitionData> &Transitions,
-              const std::shared_ptr<Config> Conf) {
-  const auto Run = [Transitions, &Conf](const auto &QueriedType) {
-    const auto Query =
-        getQueriedTypesForInput(*Transitions, fmt::format("{}", QueriedType));
-    auto Data = runGraphBuilding(Transitions, Query, Conf);
-    std::ignore = runPathFinding(Data);
+              const std::shared_ptr<Config> Conf,
+              QueryReportWriter *const Writer) {
+  const auto Cache = Conf->EnableSharedExpansionCache
+                         ? std::make_shared<ExpansionCache>(Transitions)
+                         : std::shared_ptr<ExpansionCache>{};
+  const auto Queries = getScheduledQueries(*Transitions);
+  const auto NumThreads =
+      static_cast<size_t>(tbb::this_task_arena::max_concurrency());
+  spdlog::trace("Running {} queries of {} transitions with {} threads",
+                Queries.size(), Transitions->Data.size(), NumThreads);
+
+  // the workers take the next query in the order of the schedule, unlike
+  // tbb::parallel_for_each, which splits the queries into ranges
+  auto NextQuery = std::atomic<size_t>{0U};
+  auto NumTruncatedQueries = std::atomic<size_t>{0U};
+  const auto RunQueries = [&Transitions, &Conf, &Cache, Writer, &Queries,
+                           &NextQuery, &NumTruncatedQueries]() {
+    auto QueryIndex = NextQuery++;
+    while (QueryIndex < Queries.size()) {
+      const auto Report =
+          runQuery(Transitions, Queries[QueryIndex], Conf, Cache,
+                   QueryOptions{.RankPaths = Writer != nullptr});
+      if (Report.Truncated) {
+        ++NumTruncatedQueries;
+        spdlog::warn("query {} exceeded its budget after {} vertices",
+                     Report.Query, Report.VertexCount);
+      }
+      if (Writer != nullptr) {
+        Writer->write(Report);
+      }
+      QueryIndex = NextQuery++;
+    }
   };
 
-  spdlog::trace("Running with {} threads",
-                tbb::this_task_arena::max_concurrency());
-  tbb::parallel_for_each(
-      Transitions->Data | ranges::views::transform(ToAcquired), Run);
+  auto Workers = tbb::task_group{};
+  ranges::for_each(ranges::views::indices(NumThreads),
+                   [&Workers, &RunQueries](const size_t /*Worker*/) {
+                     Workers.run(RunQueries);
+                   });
+  Workers.wait();
+  if (NumTruncatedQueries != 0U) {
+    spdlog::warn("{} of {} queries were truncated", NumTruncatedQueries.load(),
+                 Queries.size());
+  }
 }
@@ -0,0 +1,138 @@
+#include "get_me/query_report.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/raw_ostream.h>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/view/transform.hpp>
+
+namespace {
+// File layout of the binary format: magic, version as 64-bit little endian,
+// followed by the records of toBinaryRecord
+constexpr std::string_view Magic = "GETMERPT";
+constexpr std::uint64_t Version = 2U;
+
+[[nodiscard]] std::string escapeJson(const std::string_view Str) {
+  auto Escaped = std::string{};
+  Escaped.reserve(Str.size());
+  ranges::for_each(Str, [&Escaped](const char Character) {
+    switch (Character) {
+    case '"':
+      Escaped += R"(\")";
+      return;
+    case '\\':
+      Escaped += R"(\\)";
+      return;
+    case '\n':
+      Escaped += R"(\n)";
+      return;
+    case '\t':
+      Escaped += R"(\t)";
+      return;
+    default:
+      break;
+    }
+    if (static_cast<unsigned char>(Character) < 0x20U) {
+      Escaped += fmt::format(R"(\u{:04x})",
+                             static_cast<unsigned char>(Character));
+      return;
+    }
+    Escaped += Character;
+  });
+  return Escaped;
+}
+
+[[nodiscard]] std::string
+toJsonArray(const std::vector<std::string> &Strings) {
+  return fmt::format(
+      "[{}]", fmt::join(Strings | ranges::views::transform(
+                                      [](const std::string &Str) {
+                                        return fmt::format(R"("{}")",
+                                                           escapeJson(Str));
+                                      }),
+                        ","));
+}
+
+void appendU64(std::string &Buffer, const std::uint64_t Val) {
+  auto Bytes = std::array<char, sizeof(std::uint64_t)>{};
+  llvm::support::endian::write64le(Bytes.data(), Val);
+  Buffer.append(Bytes.data(), Bytes.size());
+}
+
+void appendString(std::string &Buffer, const std::string_view Str) {
+  appendU64(Buffer, Str.size());
+  Buffer.append(Str);
+}
+
+void appendStrings(std::string &Buffer,
+                   const std::vector<std::string> &Strings) {
+  appendU64(Buffer, Strings.size());
+  ranges::for_each(Strings, [&Buffer](const std::string &Str) {
+    appendString(Buffer, Str);
+  });
+}
+} // namespace
+
+std::string toJsonLine(const QueryReport &Report) {
+  return fmt::format(
+      R"({{"query":{},"path_count":{},"vertices":{},"edges":{},)"
+      R"("truncated":{},"timings_us":{{"graph_building":{},)"
+      R"("path_finding":{},"ranking":{}}},"paths":{}}})",
+      toJsonArray(Report.Query), Report.PathCount, Report.VertexCount,
+      Report.EdgeCount, Report.Truncated, Report.GraphBuildingTime.count(),
+      Report.PathFindingTime.count(), Report.RankingTime.count(),
+      toJsonArray(Report.Paths));
+}
+
+std::string toBinaryRecord(const QueryReport &Report) {
+  auto Body = std::string{};
+  appendU64(Body, Report.PathCount);
+  appendU64(Body, Report.VertexCount);
+  appendU64(Body, Report.EdgeCount);
+  appendU64(Body, Report.Truncated ? 1U : 0U);
+  appendU64(Body, static_cast<std::uint64_t>(Report.GraphBuildingTime.count()));
+  appendU64(Body, static_cast<std::uint64_t>(Report.PathFindingTime.count()));
+  appendU64(Body, static_cast<std::uint64_t>(Report.RankingTime.count()));
+  appendStrings(Body, Report.Query);
+  appendStrings(Body, Report.Paths);
+
+  auto Record = std::string{};
+  appendString(Record, Body);
+  return Record;
+}
+
+QueryReportWriter::QueryReportWriter(llvm::raw_ostream &Stream,
+                                     const QueryReportFormat Format)
+    : Stream_{&Stream},
+      Format_{Format} {
+  if (Format_ == QueryReportFormat::Binary) {
+    auto Header = std::string{Magic};
+    appendU64(Header, Version);
+    *Stream_ << Header;
+  }
+}
+
+void QueryReportWriter::write(const QueryReport &Report) {
+  const auto Record = Format_ == QueryReportFormat::JsonLines
+                          ? toJsonLine(Report) + '\n'
+                          : toBinaryRecord(Report);
+  const auto Lock = std::scoped_lock{Mutex_};
+  *Stream_ << Record;
+  ++NumWrittenReports_;
+}
+
+std::size_t QueryReportWriter::size() const {
+  const auto Lock = std::scoped_lock{Mutex_};
+  return NumWrittenReports_;
+}
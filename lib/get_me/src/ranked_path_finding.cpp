@@ -0,0 +1,259 @@
+#include "get_me/ranked_path_finding.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <range/v3/action/push_back.hpp>
+#include <range/v3/action/remove_if.hpp>
+#include <range/v3/action/sort.hpp>
+#include <range/v3/action/unique.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+#include <range/v3/algorithm/equal_range.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/algorithm/none_of.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/range/primitives.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/for_each.hpp>
+#include <range/v3/view/indices.hpp>
+#include <range/v3/view/take.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me/type_set.hpp"
+#include "support/ranges/functional.hpp"
+
+namespace {
+[[nodiscard]] auto getOutEdges(const GraphData &Data,
+                               const VertexDescriptor Vertex) {
+  return ranges::equal_range(Data.Edges, Vertex, std::less{}, Source);
+}
+
+[[nodiscard]] bool endsInLeaf(const GraphData &Data, const PathType &Path) {
+  return Data.LeafVertices.test(Target(ranges::back(Path)));
+}
+
+[[nodiscard]] size_t getNumRemainingTypes(const GraphData &Data,
+                                          const PathType &Path) {
+  return Data.VertexData[Target(ranges::back(Path))].size();
+}
+
+// the completed paths of one length, best first, without permutations of
+// each other
+[[nodiscard]] std::vector<PathType>
+rankCompletedPaths(const GraphData &Data, const std::vector<PathType> &Paths) {
+  const auto Rank = [&Data](const PathType &Path) {
+    return std::pair{getNumRemainingTypes(Data, Path),
+                     Path | ranges::views::transform(
+                                &TransitionEdgeType::TransitionIndex) |
+                         ranges::to_vector};
+  };
+  auto SeenSignatures = PathSignatureSet{};
+  return Paths |
+         ranges::views::filter([&Data](const PathType &Path) {
+           return endsInLeaf(Data, Path);
+         }) |
+         ranges::to_vector | ranges::actions::sort(std::less<>{}, Rank) |
+         ranges::actions::remove_if([&Data,
+                                     &SeenSignatures](const PathType &Path) {
+           return !SeenSignatures.emplace(getPathSignature(Path, Data)).second;
+         });
+}
+
+// the acquisition cost of every vertex, a lower bound of the edges a path
+// needs after reaching the vertex to acquire all remaining types. Only used
+// as a bound without remaining types, otherwise paths can end with types
+// that are not acquired.
+[[nodiscard]] std::vector<size_t>
+getMinRemainingPathLengths(const GraphData &Data) {
+  if (Data.Conf->MaxRemainingTypes != 0U) {
+    return std::vector<size_t>(Data.VertexData.size());
+  }
+  return Data.VertexData |
+         ranges::views::transform([&Data](const TypeSet &Vertex) {
+           return Data.Transitions->getAcquisitionCost(
+               Data.Transitions->getTypeIds(Vertex));
+         }) |
+         ranges::to_vector;
+}
+
+[[nodiscard]] bool
+canCompleteWithin(const std::vector<size_t> &MinRemainingPathLengths,
+                  const size_t PathLength, const VertexDescriptor Vertex,
+                  const size_t MaxPathLength) {
+  return SafePlus(PathLength, MinRemainingPathLengths[Vertex]) <=
+         MaxPathLength;
+}
+
+// the same restrictions as the backwards search of runPathFinding: every
+// transition and every source vertex is used at most once, with backwards
+// edges every target vertex is visited at most once, and with path order
+// reduction only the canonical order of commuting transitions is taken if the
+// swapped order is taken as well
+[[nodiscard]] bool
+canExtendPathWith(const GraphData &Data, const PathType &Path,
+                  const TransitionEdgeType &Edge,
+                  const std::vector<size_t> &MinRemainingPathLengths) {
+  const auto &First = ranges::back(Path);
+  const auto CanSwapOrderThrough = [&Data, &Path, &Edge, &First,
+                                    &MinRemainingPathLengths](
+                                       const VertexDescriptor Swapped) {
+    return canCompleteWithin(MinRemainingPathLengths, Path.size(), Swapped,
+                             Data.Conf->MaxPathLength) &&
+           canSwapOrderThrough(Data, Path, First, Edge, Swapped);
+  };
+  if (Data.Conf->EnablePathOrderReduction &&
+      ranges::any_of(getSwappedOrderVertices(Data, First, Edge),
+                     CanSwapOrderThrough)) {
+    return false;
+  }
+  return ranges::none_of(Path,
+                         [&Data, &Edge](const TransitionEdgeType &EdgeInPath) {
+                           return Source(EdgeInPath) == Source(Edge) ||
+                                  (Data.Conf->EnableGraphBackwardsEdge &&
+                                   Target(EdgeInPath) == Target(Edge));
+                         }) &&
+         canTakeDistinctTransitions(Data, Path, Edge);
+}
+
+// the number of edges of the shortest path from every vertex to a leaf
+// vertex, an admissible lower bound of the edges a path needs after reaching
+// the vertex to complete. Vertices that reach no leaf have the maximum.
+[[nodiscard]] std::vector<size_t> getMinLeafDistances(const GraphData &Data) {
+  auto Distances = std::vector<size_t>(Data.VertexData.size(),
+                                       std::numeric_limits<size_t>::max());
+  auto Frontier = ranges::views::indices(Data.VertexData.size()) |
+                  ranges::views::filter([&Data](const VertexDescriptor Vertex) {
+                    return Data.LeafVertices.test(Vertex);
+                  }) |
+                  ranges::to_vector;
+  auto Distance = size_t{0U};
+  while (!Frontier.empty()) {
+    ranges::for_each(Frontier, [&Distances,
+                                Distance](const VertexDescriptor Vertex) {
+      Distances[Vertex] = Distance;
+    });
+    ++Distance;
+    Frontier =
+        Frontier |
+        ranges::views::for_each([&Data](const VertexDescriptor Vertex) {
+          return Data.getIncomingEdges(Vertex) |
+                 ranges::views::transform(Source);
+        }) |
+        ranges::views::filter([&Distances](const VertexDescriptor Vertex) {
+          return Distances[Vertex] == std::numeric_limits<size_t>::max();
+        }) |
+        ranges::to_vector | ranges::actions::sort | ranges::actions::unique;
+  }
+  return Distances;
+}
+
+// a path of the best-first search, with the lower bound of the length of its
+// completions
+struct SearchEntry {
+  size_t MinLength;
+  size_t NumRemainingTypes;
+  PathType Path;
+};
+
+// orders the priority queue with the entry of the shortest completions and
+// then the fewest remaining types on top
+[[nodiscard]] bool isWorseEntry(const SearchEntry &Lhs,
+                                const SearchEntry &Rhs) {
+  return std::pair{Lhs.MinLength, Lhs.NumRemainingTypes} >
+         std::pair{Rhs.MinLength, Rhs.NumRemainingTypes};
+}
+
+using SearchQueue = std::priority_queue<SearchEntry, std::vector<SearchEntry>,
+                                        decltype(&isWorseEntry)>;
+} // namespace
+
+std::vector<PathType>
+runTopKPathFinding(const GraphData &Data, const size_t MaxPathCount,
+                   const std::chrono::steady_clock::time_point Deadline) {
+  // the acquisition costs prune paths that can not acquire their remaining
+  // types within MaxPathLength, the leaf distances order the search
+  const auto MinRemainingPathLengths = getMinRemainingPathLengths(Data);
+  const auto MinLeafDistances = getMinLeafDistances(Data);
+  const auto MaxPathLength = Data.Conf->MaxPathLength;
+  auto Queue = SearchQueue{&isWorseEntry};
+  const auto PushIfCompletable = [&Data, &MinRemainingPathLengths,
+                                  &MinLeafDistances, MaxPathLength,
+                                  &Queue](PathType Path) {
+    const auto Vertex = Target(ranges::back(Path));
+    const auto MinLength = SafePlus(Path.size(), MinLeafDistances[Vertex]);
+    if (MinLength > MaxPathLength ||
+        !canCompleteWithin(MinRemainingPathLengths, Path.size(), Vertex,
+                           MaxPathLength)) {
+      return;
+    }
+    Queue.push(SearchEntry{MinLength, getNumRemainingTypes(Data, Path),
+                           std::move(Path)});
+  };
+  ranges::for_each(
+      ranges::views::indices(Data.VertexData.size()) |
+          ranges::views::filter([&Data](const VertexDescriptor Vertex) {
+            return Data.RootVertices.test(Vertex);
+          }) |
+          ranges::views::for_each([&Data](const VertexDescriptor Root) {
+            return getOutEdges(Data, Root);
+          }),
+      [&PushIfCompletable](const TransitionEdgeType &Edge) {
+        PushIfCompletable(PathType{Edge});
+      });
+
+  auto RankedPaths = std::vector<PathType>{};
+  // the completed paths of the current length. Every prefix of a path of
+  // this length has a lower bound of at most the length, the paths of a
+  // length are all known once an entry with a larger bound is on top.
+  auto CompletedPaths = std::vector<PathType>{};
+  const auto RankCompletedPaths = [&Data, &RankedPaths, &CompletedPaths,
+                                   MaxPathCount]() {
+    const auto NumMissingPaths = MaxPathCount - RankedPaths.size();
+    ranges::push_back(RankedPaths,
+                      rankCompletedPaths(Data, CompletedPaths) |
+                          ranges::views::take(
+                              static_cast<std::ptrdiff_t>(NumMissingPaths)));
+    CompletedPaths.clear();
+  };
+
+  while (!Queue.empty() && RankedPaths.size() < MaxPathCount &&
+         std::chrono::steady_clock::now() < Deadline) {
+    auto Entry = Queue.top();
+    Queue.pop();
+    if (!CompletedPaths.empty() &&
+        Entry.MinLength > CompletedPaths.front().size()) {
+      RankCompletedPaths();
+      if (RankedPaths.size() == MaxPathCount) {
+        break;
+      }
+    }
+    if (endsInLeaf(Data, Entry.Path)) {
+      CompletedPaths.push_back(std::move(Entry.Path));
+      continue;
+    }
+    ranges::for_each(
+        getOutEdges(Data, Target(ranges::back(Entry.Path))) |
+            ranges::views::filter([&Data, &Entry, &MinRemainingPathLengths](
+                                      const TransitionEdgeType &Edge) {
+              return canExtendPathWith(Data, Entry.Path, Edge,
+                                       MinRemainingPathLengths);
+            }),
+        [&Entry, &PushIfCompletable](const TransitionEdgeType &Edge) {
+          PushIfCompletable(Copy(Entry.Path) |
+                            ranges::actions::push_back(Edge));
+        });
+  }
+  if (RankedPaths.size() < MaxPathCount) {
+    RankCompletedPaths();
+  }
+
+  return RankedPaths;
+}
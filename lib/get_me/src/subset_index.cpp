@@ -0,0 +1,40 @@
+#include "get_me/subset_index.hpp"
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+
+#include "get_me/type_id_set.hpp"
+
+void SubsetIndex::insert(const TypeIdSet &Val) {
+  if (Val.empty()) {
+    return;
+  }
+  const auto SetIndex = SetSizes_.size();
+  SetSizes_.push_back(Val.size());
+  ranges::for_each(Val, [this, SetIndex](const TypeId Id) {
+    SetsWithType_[Id].push_back(SetIndex);
+  });
+}
+
+bool SubsetIndex::containsStrictSubsetOf(const TypeIdSet &Val) const {
+  // the number of types of Val every visited set contains
+  auto NumContainedTypes =
+      boost::unordered_flat_map<std::size_t, std::size_t>{};
+  const auto Size = Val.size();
+  return ranges::any_of(Val, [this, &NumContainedTypes,
+                              Size](const TypeId Id) {
+    const auto Sets = SetsWithType_.find(Id);
+    if (Sets == SetsWithType_.end()) {
+      return false;
+    }
+    return ranges::any_of(Sets->second, [this, &NumContainedTypes,
+                                         Size](const std::size_t SetIndex) {
+      const auto SetSize = SetSizes_[SetIndex];
+      return ++NumContainedTypes[SetIndex] == SetSize && SetSize < Size;
+    });
+  });
+}
@@ -1,6 +1,14 @@
 #include "get_me/tooling.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <variant>
@@ -21,14 +29,32 @@
 #include <clang/AST/Type.h>
 #include <clang/Basic/Specifiers.h>
 #include <clang/Frontend/ASTUnit.h>
+#include <clang/Index/USRGeneration.h>
 #include <clang/Sema/Sema.h>
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <fmt/core.h>
 #include <fmt/ranges.h> // IWYU pragma: keep
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/task_arena.h>
+#include <range/v3/action/push_back.hpp>
 #include <range/v3/action/remove_if.hpp>
 #include <range/v3/algorithm/contains.hpp>
 #include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
 #include <range/v3/range/primitives.hpp>
+#include <range/v3/view/chunk.hpp>
 #include <range/v3/view/filter.hpp>
+#include <range/v3/view/indices.hpp>
+#include <range/v3/view/join.hpp>
+#include <range/v3/view/move.hpp>
 #include <range/v3/view/transform.hpp>
 #include <spdlog/spdlog.h>
 
@@ -38,7 +64,9 @@
 #include "get_me/propagate_type_aliasing.hpp"
 #include "get_me/propagate_type_conversions.hpp"
 #include "get_me/tooling_filters.hpp"
+#include "get_me/transition_index.hpp"
 #include "get_me/transitions.hpp"
+#include "get_me/type_conversion_map.hpp"
 #include "get_me/type_set.hpp"
 #include "support/get_me_exception.hpp"
 #include "support/ranges/functional.hpp"
@@ -68,6 +96,10 @@ public:
 
   void HandleTranslationUnit(clang::ASTContext &Context) override;
 
+  // collect the transitions of the translation unit without propagating type
+  // conversions or committing them
+  void collect(clang::ASTContext &Context);
+
 private:
   std::shared_ptr<Config> Conf_;
   std::shared_ptr<TransitionData> Transitions_;
@@ -97,6 +129,16 @@ public:
     return true;
   }
 
+  [[nodiscard]] bool TraverseStmt(clang::Stmt *Stmt,
+                                  DataRecursionQueue *Queue = nullptr) {
+    // only declarations provide transitions, statements (e.g., function
+    // bodies and initializers) are not traversed in declaration-only mode
+    if (Conf_->EnableSkipFunctionBodies) {
+      return true;
+    }
+    return clang::RecursiveASTVisitor<GetMeVisitor>::TraverseStmt(Stmt, Queue);
+  }
+
   [[nodiscard]] bool VisitFunctionDecl(clang::FunctionDecl *FDecl) {
     // handled differently via iterating over a CXXRecord's methods
     if (llvm::isa<clang::CXXMethodDecl>(FDecl)) {
@@ -271,7 +313,7 @@ private:
   clang::Sema &Sema_;
 };
 
-void GetMe::HandleTranslationUnit(clang::ASTContext &Context) {
+void GetMe::collect(clang::ASTContext &Context) {
   std::vector<const clang::CXXRecordDecl *> CXXRecords{};
   std::vector<TransparentType> TypedefNameDecls{};
   GetMeVisitor Visitor{Conf_, *Transitions_, CXXRecords, TypedefNameDecls,
@@ -285,12 +327,195 @@ void GetMe::HandleTranslationUnit(clang::ASTContext &Context) {
   if (Conf_->EnablePropagateTypeAlias) {
     propagateTypeAliasing(Transitions_->ConversionMap, TypedefNameDecls);
   }
+}
+
+void GetMe::HandleTranslationUnit(clang::ASTContext &Context) {
+  collect(Context);
 
   propagateTypeConversions(*Transitions_);
 
   Transitions_->commit();
 }
 
+namespace {
+// Merges the transitions of multiple translation units and detaches them from
+// their ASTs: types become IndexedTypes and declarations IndexedDecls that are
+// owned by the TransitionIndexStorage of the result, the AST of a translation
+// unit can be released as soon as its transitions are merged. Types are
+// identified by their printed name and USR, i.e., types with the same name in
+// different anonymous namespaces or functions stay distinct. Declarations that
+// were already seen in another translation unit (same USR) are dropped.
+class TransitionDataMerger {
+public:
+  // the AST of Transitions is only used while merging
+  void merge(const TransitionData &Transitions, clang::ASTContext &Context) {
+    ranges::for_each(Transitions.Data, [this, &Context](
+                                           const TransitionType &Transition) {
+      auto Key = std::pair{canonicalize(ToAcquired(Transition), Context),
+                           canonicalize(ToRequired(Transition), Context)};
+      auto &SeenUSRs = SeenTransitions_[Key];
+      auto &Merged = Value(Result_.Data[std::move(Key)]);
+      ranges::for_each(
+          ToTransitions(Transition) | ranges::views::transform(ToTransition),
+          [this, &SeenUSRs, &Merged](const TransitionDataType &Decl) {
+            auto USR = getTransitionUSR(Decl);
+            if (SeenUSRs.contains(USR)) {
+              return;
+            }
+            Merged.emplace(StrippedTransitionType{
+                0U, TransitionDataType{detach(Decl, USR)}});
+            SeenUSRs.emplace(std::move(USR));
+          });
+    });
+
+    ranges::for_each(
+        Transitions.ConversionMap,
+        [this, &Context](const TypeConversionMap::value_type &Conversion) {
+          const auto &[Key, ConversionSet] = Conversion;
+          auto CanonicalConversionSet = canonicalize(ConversionSet, Context);
+          Result_.ConversionMap[canonicalize(Key, Context)].merge(
+              CanonicalConversionSet);
+        });
+  }
+
+  // propagates the type conversions of all merged translation units
+  [[nodiscard]] std::shared_ptr<TransitionData> takeResult() {
+    const auto LookupDetached = [](const std::vector<Type> &Detached) {
+      return [&Detached](const Type &Val) {
+        return std::visit(
+            Overloaded{[&Detached](const IndexedType &Indexed) -> Type {
+                         return Detached[Indexed.Id];
+                       },
+                       [](const auto &Other) -> Type { return Other; }},
+            Val);
+      };
+    };
+    propagateTypeConversions(
+        Result_,
+        {.StripPointerRef = LookupDetached(StrippedPointerRefs_),
+         .RemoveLocalConst = LookupDetached(RemovedLocalConsts_)});
+    Result_.IndexStorage = std::move(Storage_);
+    Result_.commit();
+    return std::make_shared<TransitionData>(std::move(Result_));
+  }
+
+private:
+  [[nodiscard]] Type canonicalize(const Type &Val,
+                                  clang::ASTContext &Context) {
+    return std::visit(
+        Overloaded{[this, &Context](const clang::QualType &QType) -> Type {
+                     return detach(QType, Context);
+                   },
+                   [](const auto &Other) -> Type { return Other; }},
+        Val);
+  }
+
+  [[nodiscard]] TransparentType canonicalize(const TransparentType &Val,
+                                             clang::ASTContext &Context) {
+    return {.Desugared = canonicalize(Val.Desugared, Context),
+            .Actual = canonicalize(Val.Actual, Context)};
+  }
+
+  [[nodiscard]] TypeSet canonicalize(const TypeSet &Val,
+                                     clang::ASTContext &Context) {
+    return Val |
+           ranges::views::transform(
+               [this, &Context](const TransparentType &Transparent) {
+                 return canonicalize(Transparent, Context);
+               }) |
+           ranges::to<TypeSet>;
+  }
+
+  // the operations of propagateTypeConversions need the AST, their results are
+  // detached together with the type
+  [[nodiscard]] IndexedType detach(const clang::QualType &QType,
+                                   clang::ASTContext &Context) {
+    auto USR = llvm::SmallString<128>{};
+    if (clang::index::generateUSRForType(QType, Context, USR)) {
+      // no USR available, the type is identified by its name
+      USR.clear();
+    }
+    auto Key = std::pair{fmt::format("{}", QType), USR.str().str()};
+    if (const auto Iter = Types_.find(Key); Iter != Types_.end()) {
+      return Iter->second;
+    }
+
+    const auto Detached =
+        IndexedType{.Id = static_cast<std::uint32_t>(Types_.size()),
+                    .Name = Storage_->Strings.emplace_back(Key.first)};
+    Types_.emplace(std::move(Key), Detached);
+    StrippedPointerRefs_.emplace_back(Detached);
+    RemovedLocalConsts_.emplace_back(Detached);
+
+    const auto Operations = getQualTypeConversionOperations();
+    auto StrippedPointerRef =
+        canonicalize(Operations.StripPointerRef(QType), Context);
+    StrippedPointerRefs_[Detached.Id] = std::move(StrippedPointerRef);
+    auto RemovedLocalConst =
+        canonicalize(Operations.RemoveLocalConst(QType), Context);
+    RemovedLocalConsts_[Detached.Id] = std::move(RemovedLocalConst);
+    return Detached;
+  }
+
+  [[nodiscard]] const IndexedDecl *detach(const TransitionDataType &Decl,
+                                          const std::string &USR) {
+    if (const auto Iter = Decls_.find(USR); Iter != Decls_.end()) {
+      return Iter->second;
+    }
+    const auto Store = [this](std::string Str) -> std::string_view {
+      return Storage_->Strings.emplace_back(std::move(Str));
+    };
+    const auto *const Detached = &Storage_->Decls.emplace_back(IndexedDecl{
+        .USR = Store(USR),
+        .Name = Store(getTransitionName(Decl)),
+        .AcquiredTypeNames = Store(getTransitionAcquiredTypeNames(Decl)),
+        .RequiredTypeNames = Store(getTransitionRequiredTypeNames(Decl))});
+    Decls_.emplace(USR, Detached);
+    return Detached;
+  }
+
+  TransitionData Result_;
+  std::shared_ptr<TransitionIndexStorage> Storage_ =
+      std::make_shared<TransitionIndexStorage>();
+  // the detached types by their printed name and USR
+  std::map<std::pair<std::string, std::string>, IndexedType> Types_;
+  // the results of the operations of propagateTypeConversions, indexed by the
+  // id of the detached type
+  std::vector<Type> StrippedPointerRefs_;
+  std::vector<Type> RemovedLocalConsts_;
+  std::map<std::string, const IndexedDecl *, std::less<>> Decls_;
+  std::map<TransitionType::first_type, std::set<std::string, std::less<>>>
+      SeenTransitions_;
+};
+
+// collects the transitions of every translation unit in parallel, merging
+// requires their ASTs and is sequential
+void mergeTranslationUnits(
+    TransitionDataMerger &Merger,
+    const std::vector<std::unique_ptr<clang::ASTUnit>> &ASTs,
+    const std::shared_ptr<Config> &Conf) {
+  auto TranslationUnitTransitions =
+      std::vector<std::shared_ptr<TransitionData>>(ASTs.size());
+  tbb::parallel_for(size_t{0U}, ASTs.size(),
+                    [&ASTs, &TranslationUnitTransitions,
+                     &Conf](const size_t Index) {
+                      auto Transitions = std::make_shared<TransitionData>();
+                      auto &AST = *ASTs[Index];
+                      GetMe{Conf, Transitions, AST.getSema()}.collect(
+                          AST.getASTContext());
+                      TranslationUnitTransitions[Index] =
+                          std::move(Transitions);
+                    });
+
+  ranges::for_each(ranges::views::indices(ASTs.size()),
+                   [&Merger, &ASTs,
+                    &TranslationUnitTransitions](const size_t Index) {
+                     Merger.merge(*TranslationUnitTransitions[Index],
+                                  ASTs[Index]->getASTContext());
+                   });
+}
+} // namespace
+
 std::shared_ptr<TransitionData>
 collectTransitions(clang::ASTUnit &AST, std::shared_ptr<Config> Conf) {
   auto Transitions = std::make_shared<TransitionData>();
@@ -298,3 +523,87 @@ collectTransitions(clang::ASTUnit &AST, std::shared_ptr<Config> Conf) {
       AST.getASTContext());
   return Transitions;
 }
+
+std::shared_ptr<TransitionData>
+collectTransitions(const std::vector<std::unique_ptr<clang::ASTUnit>> &ASTs,
+                   std::shared_ptr<Config> Conf) {
+  if (ASTs.size() == 1U) {
+    return collectTransitions(*ASTs.front(), std::move(Conf));
+  }
+
+  auto Merger = TransitionDataMerger{};
+  mergeTranslationUnits(Merger, ASTs, Conf);
+  auto Transitions = Merger.takeResult();
+  spdlog::trace("collected {} transitions from {} translation units",
+                Transitions->getNumTransitions(), ASTs.size());
+  return Transitions;
+}
+
+std::shared_ptr<TransitionData>
+collectTransitions(const clang::tooling::CompilationDatabase &Compilations,
+                   const std::vector<std::string> &Sources,
+                   std::shared_ptr<Config> Conf,
+                   const clang::tooling::ArgumentsAdjuster &Adjuster) {
+  const auto BatchSize = static_cast<size_t>(
+      std::max(tbb::this_task_arena::max_concurrency(), 1));
+  auto Merger = TransitionDataMerger{};
+  ranges::for_each(
+      Sources | ranges::views::chunk(BatchSize),
+      [&Compilations, &Adjuster, &Conf, &Merger](const auto &Batch) {
+        // the ASTs of the batch are released when they go out of scope
+        const auto ASTs =
+            buildASTs(Compilations, Batch | ranges::to<std::vector>, Adjuster);
+        mergeTranslationUnits(Merger, ASTs, Conf);
+      });
+  auto Transitions = Merger.takeResult();
+  spdlog::trace("collected {} transitions from {} sources",
+                Transitions->getNumTransitions(), Sources.size());
+  return Transitions;
+}
+
+std::vector<std::string> getParseArguments(const Config &Conf) {
+  if (Conf.EnableSkipFunctionBodies) {
+    return {"-Xclang", "-skip-function-bodies"};
+  }
+  return {};
+}
+
+clang::tooling::ArgumentsAdjuster
+getParseArgumentsAdjuster(std::shared_ptr<Config> Conf) {
+  return [Conf = std::move(Conf)](
+             const clang::tooling::CommandLineArguments &Args,
+             const llvm::StringRef /*Filename*/) {
+    auto Res = Args;
+    ranges::push_back(Res, getParseArguments(*Conf));
+    return Res;
+  };
+}
+
+std::vector<std::unique_ptr<clang::ASTUnit>>
+buildASTs(const clang::tooling::CompilationDatabase &Compilations,
+          const std::vector<std::string> &Sources,
+          const clang::tooling::ArgumentsAdjuster &Adjuster) {
+  auto ASTsPerSource =
+      std::vector<std::vector<std::unique_ptr<clang::ASTUnit>>>(
+          Sources.size());
+  tbb::parallel_for(
+      size_t{0U}, Sources.size(),
+      [&Compilations, &Sources, &Adjuster, &ASTsPerSource](const size_t Index) {
+        // every tool gets its own physical file system, otherwise changing
+        // into the directory of a compile command changes the working
+        // directory of the process for all tools
+        auto Tool = clang::tooling::ClangTool{
+            Compilations, llvm::ArrayRef<std::string>{Sources[Index]},
+            std::make_shared<clang::PCHContainerOperations>(),
+            llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>{
+                llvm::vfs::createPhysicalFileSystem()}};
+        if (Adjuster) {
+          Tool.appendArgumentsAdjuster(Adjuster);
+        }
+        GetMeException::verify(Tool.buildASTs(ASTsPerSource[Index]) == 0,
+                               "Error building ASTs for {}", Sources[Index]);
+      });
+
+  return ASTsPerSource | ranges::views::move | ranges::views::join |
+         ranges::views::move | ranges::to_vector;
+}
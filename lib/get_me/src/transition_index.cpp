@@ -0,0 +1,336 @@
+#include "get_me/transition_index.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <boost/container/flat_set.hpp>
+#include <fmt/core.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/generate_n.hpp>
+#include <range/v3/view/join.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/transitions.hpp"
+#include "get_me/type_conversion_map.hpp"
+#include "get_me/type_set.hpp"
+#include "support/get_me_exception.hpp"
+
+namespace {
+// File layout, all integers are 32-bit little endian:
+//   magic, version
+//   strings:     count, (size, bytes)...
+//   types:       count, name...                  (the id of a type is its
+//                                                 position)
+//   decls:       count, (usr, name, acquired names, required names)...
+//   transitions: count, (acquired, required set, decl count, decl...)...
+//   conversions: count, (type, conversion set)...
+// where a transparent type is a pair of type ids (desugared, actual), a set is
+// a count followed by its transparent types and strings are referenced by
+// their index in the string table.
+constexpr std::string_view Magic = "GETMEIDX";
+constexpr std::uint32_t Version = 1U;
+constexpr auto IdSize = sizeof(std::uint32_t);
+
+void appendU32(std::string &Buffer, const std::uint32_t Val) {
+  auto Bytes = std::array<char, sizeof(std::uint32_t)>{};
+  llvm::support::endian::write32le(Bytes.data(), Val);
+  Buffer.append(Bytes.data(), Bytes.size());
+}
+
+[[nodiscard]] std::uint32_t toU32(const size_t Val) {
+  GetMeException::verify(Val <= std::numeric_limits<std::uint32_t>::max(),
+                         "transition index: {} does not fit into 32 bits",
+                         Val);
+  return static_cast<std::uint32_t>(Val);
+}
+
+[[nodiscard]] boost::container::flat_set<Type>
+collectTypes(const TransitionData &Transitions) {
+  auto Types = std::vector<Type>{};
+  const auto AddType = [&Types](const TransparentType &Val) {
+    Types.push_back(Val.Desugared);
+    Types.push_back(Val.Actual);
+  };
+  ranges::for_each(Transitions.Data,
+                   [&AddType](const TransitionType &Transition) {
+                     AddType(ToAcquired(Transition));
+                     ranges::for_each(ToRequired(Transition), AddType);
+                   });
+  ranges::for_each(Transitions.ConversionMap,
+                   [&Types, &AddType](
+                       const TypeConversionMap::value_type &Conversion) {
+                     Types.push_back(Conversion.first);
+                     ranges::for_each(Conversion.second, AddType);
+                   });
+  return {Types.begin(), Types.end()};
+}
+
+class TransitionIndexWriter {
+public:
+  explicit TransitionIndexWriter(const TransitionData &Transitions)
+      : Transitions_{Transitions},
+        Types_{collectTypes(Transitions)} {}
+
+  [[nodiscard]] std::string serialize() {
+    writeSize(Types_.size());
+    ranges::for_each(Types_, [this](const Type &Val) {
+      writeString(fmt::format("{}", Val));
+    });
+
+    // the id of a declaration is its transition index
+    writeSize(Transitions_.getNumTransitions());
+    ranges::for_each(
+        Transitions_.Data | ranges::views::transform(ToTransitions) |
+            ranges::views::join | ranges::views::transform(ToTransition),
+        [this](const TransitionDataType &Transition) {
+          writeString(getTransitionUSR(Transition));
+          writeString(getTransitionName(Transition));
+          writeString(getTransitionAcquiredTypeNames(Transition));
+          writeString(getTransitionRequiredTypeNames(Transition));
+        });
+
+    writeSize(Transitions_.Data.size());
+    ranges::for_each(Transitions_.Data, [this](
+                                            const TransitionType &Transition) {
+      writeTransparentType(ToAcquired(Transition));
+      writeTypeSet(ToRequired(Transition));
+      writeSize(ToTransitions(Transition).size());
+      ranges::for_each(ToTransitions(Transition) |
+                           ranges::views::transform(ToTransitionIndex),
+                       [this](const size_t Index) { writeSize(Index); });
+    });
+
+    writeSize(Transitions_.ConversionMap.size());
+    ranges::for_each(Transitions_.ConversionMap,
+                     [this](const TypeConversionMap::value_type &Conversion) {
+                       writeType(Conversion.first);
+                       writeTypeSet(Conversion.second);
+                     });
+
+    auto Result = std::string{Magic};
+    appendU32(Result, Version);
+    appendU32(Result, toU32(Strings_.size()));
+    ranges::for_each(Strings_, [&Result](const std::string_view Str) {
+      appendU32(Result, toU32(Str.size()));
+      Result.append(Str);
+    });
+    Result.append(Body_);
+    return Result;
+  }
+
+private:
+  void writeSize(const size_t Val) { appendU32(Body_, toU32(Val)); }
+
+  void writeString(std::string Str) {
+    const auto [Iter, Inserted] =
+        StringIds_.try_emplace(std::move(Str), toU32(StringIds_.size()));
+    if (Inserted) {
+      Strings_.emplace_back(Iter->first);
+    }
+    appendU32(Body_, Iter->second);
+  }
+
+  void writeType(const Type &Val) {
+    writeSize(Types_.index_of(Types_.find(Val)));
+  }
+
+  void writeTransparentType(const TransparentType &Val) {
+    writeType(Val.Desugared);
+    writeType(Val.Actual);
+  }
+
+  void writeTypeSet(const TypeSet &Val) {
+    writeSize(Val.size());
+    ranges::for_each(Val, [this](const TransparentType &Element) {
+      writeTransparentType(Element);
+    });
+  }
+
+  const TransitionData &Transitions_;
+  boost::container::flat_set<Type> Types_;
+  std::map<std::string, std::uint32_t, std::less<>> StringIds_;
+  std::vector<std::string_view> Strings_;
+  std::string Body_;
+};
+
+class TransitionIndexReader {
+public:
+  explicit TransitionIndexReader(const llvm::StringRef Data) : Data_{Data} {}
+
+  [[nodiscard]] std::uint32_t readU32() {
+    GetMeException::verify(Data_.size() >= sizeof(std::uint32_t),
+                           "transition index: unexpected end of file");
+    const auto Val = llvm::support::endian::read32le(Data_.data());
+    Data_ = Data_.drop_front(sizeof(std::uint32_t));
+    return Val;
+  }
+
+  // the number of elements that follow, each of them takes at least
+  // MinElementSize bytes. Checked before the elements are allocated, a
+  // corrupt count does not allocate more than the file could hold.
+  [[nodiscard]] std::uint32_t readCount(const size_t MinElementSize) {
+    const auto Count = readU32();
+    GetMeException::verify(Count <= Data_.size() / MinElementSize,
+                           "transition index: unexpected end of file");
+    return Count;
+  }
+
+  [[nodiscard]] std::string_view readBytes(const size_t Size) {
+    GetMeException::verify(Data_.size() >= Size,
+                           "transition index: unexpected end of file");
+    const auto Bytes = std::string_view{Data_.data(), Size};
+    Data_ = Data_.drop_front(Size);
+    return Bytes;
+  }
+
+  [[nodiscard]] bool empty() const { return Data_.empty(); }
+
+private:
+  llvm::StringRef Data_;
+};
+
+template <typename Container>
+[[nodiscard]] const auto &lookupId(const Container &Values,
+                                   const std::uint32_t Id) {
+  GetMeException::verify(Id < Values.size(),
+                         "transition index: id {} out of range ({})", Id,
+                         Values.size());
+  return Values[Id];
+}
+} // namespace
+
+void saveTransitionIndex(const TransitionData &Transitions,
+                         const std::filesystem::path &Path) {
+  auto ErrorCode = std::error_code{};
+  auto File = llvm::raw_fd_ostream{Path.string(), ErrorCode};
+  GetMeException::verify(!ErrorCode, "could not open {} for writing: {}",
+                         Path.string(), ErrorCode.message());
+  File << TransitionIndexWriter{Transitions}.serialize();
+}
+
+std::shared_ptr<TransitionData>
+loadTransitionIndex(const std::filesystem::path &Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path.string(), /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  GetMeException::verify(static_cast<bool>(Buffer), "could not open {}: {}",
+                         Path.string(), Buffer.getError().message());
+
+  auto Storage = std::make_shared<TransitionIndexStorage>();
+  Storage->Buffer = std::move(*Buffer);
+  auto Reader = TransitionIndexReader{Storage->Buffer->getBuffer()};
+
+  GetMeException::verify(Reader.readBytes(Magic.size()) == Magic,
+                         "{} is not a transition index", Path.string());
+  const auto FileVersion = Reader.readU32();
+  GetMeException::verify(FileVersion == Version,
+                         "transition index {} has version {}, expected {}",
+                         Path.string(), FileVersion, Version);
+
+  // a string takes at least its size
+  const auto StringCount = Reader.readCount(IdSize);
+  const auto Strings = ranges::views::generate_n(
+                           [&Reader]() {
+                             const auto Size = Reader.readU32();
+                             return Reader.readBytes(Size);
+                           },
+                           StringCount) |
+                       ranges::to_vector;
+  const auto ReadString = [&Reader, &Strings]() {
+    return lookupId(Strings, Reader.readU32());
+  };
+
+  // a type is its name
+  const auto TypeCount = Reader.readCount(IdSize);
+  const auto Types =
+      ranges::views::generate_n(
+          [&ReadString, Id = std::uint32_t{0U}]() mutable {
+            return Type{IndexedType{.Id = Id++, .Name = ReadString()}};
+          },
+          TypeCount) |
+      ranges::to_vector;
+  const auto ReadTransparentType = [&Reader, &Types]() {
+    return TransparentType{.Desugared = lookupId(Types, Reader.readU32()),
+                           .Actual = lookupId(Types, Reader.readU32())};
+  };
+  const auto ReadTypeSet = [&Reader, &ReadTransparentType]() {
+    // a transparent type is its desugared and actual type
+    const auto Size = Reader.readCount(2U * IdSize);
+    return ranges::views::generate_n(ReadTransparentType, Size) |
+           ranges::to<TypeSet>;
+  };
+
+  // a declaration is its usr, name, acquired and required names
+  const auto DeclCount = Reader.readCount(4U * IdSize);
+  Storage->Decls =
+      ranges::views::generate_n(
+          [&ReadString]() {
+            return IndexedDecl{.USR = ReadString(),
+                               .Name = ReadString(),
+                               .AcquiredTypeNames = ReadString(),
+                               .RequiredTypeNames = ReadString()};
+          },
+          DeclCount) |
+      ranges::to_vector;
+  const auto ReadDecl = [&Reader, &Storage]() {
+    return StrippedTransitionType{
+        0U, TransitionDataType{&lookupId(Storage->Decls, Reader.readU32())}};
+  };
+
+  auto Transitions = std::make_shared<TransitionData>();
+
+  // a transition takes at least its acquired type, an empty required set and
+  // an empty declaration list
+  const auto TransitionCount = Reader.readCount(4U * IdSize);
+  Transitions->Data =
+      ranges::views::generate_n(
+          [&Reader, &ReadTransparentType, &ReadTypeSet, &ReadDecl]() {
+            auto Acquired = ReadTransparentType();
+            auto Required = ReadTypeSet();
+            const auto Size = Reader.readCount(IdSize);
+            return TransitionType{
+                {std::move(Acquired), std::move(Required)},
+                {0U, ranges::views::generate_n(ReadDecl, Size) |
+                         ranges::to<StrippedTransitionsSet>}};
+          },
+          TransitionCount) |
+      ranges::to<TransitionData::associative_container_type>;
+
+  // a conversion takes at least its type and an empty conversion set
+  const auto ConversionCount = Reader.readCount(2U * IdSize);
+  Transitions->ConversionMap =
+      ranges::views::generate_n(
+          [&Reader, &Types, &ReadTypeSet]() {
+            auto Key = lookupId(Types, Reader.readU32());
+            return std::pair{std::move(Key), ReadTypeSet()};
+          },
+          ConversionCount) |
+      ranges::to<TypeConversionMap>;
+
+  GetMeException::verify(Reader.empty(),
+                         "transition index {} has trailing data",
+                         Path.string());
+
+  Transitions->IndexStorage = std::move(Storage);
+  // the declarations are stored in transition index order, committing
+  // reproduces the indices of the saved transitions
+  Transitions->commit();
+  return Transitions;
+}
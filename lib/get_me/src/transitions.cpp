@@ -1,27 +1,77 @@
 #include "get_me/transitions.hpp"
 
 #include <cstddef>
+#include <functional>
+#include <span>
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include <boost/container/flat_set.hpp>
 #include <clang/AST/Decl.h>
 #include <clang/AST/DeclCXX.h>
+#include <clang/Index/USRGeneration.h>
 #include <fmt/core.h>
 #include <fmt/format.h>
+#include <llvm/ADT/SmallString.h>
 #include <llvm/Support/Casting.h>
+#include <range/v3/action/push_back.hpp>
+#include <range/v3/action/sort.hpp>
+#include <range/v3/algorithm/fold_left.hpp>
+#include <range/v3/algorithm/for_each.hpp>
 #include <range/v3/algorithm/generate.hpp>
+#include <range/v3/algorithm/lower_bound.hpp>
+#include <range/v3/algorithm/max.hpp>
+#include <range/v3/iterator/operations.hpp>
 #include <range/v3/range/conversion.hpp>
+#include <range/v3/range/primitives.hpp>
 #include <range/v3/view/for_each.hpp>
+#include <range/v3/view/indices.hpp>
 #include <range/v3/view/join.hpp>
 #include <range/v3/view/map.hpp>
 #include <range/v3/view/transform.hpp>
 
+#include "get_me/type_name_index.hpp"
+#include "get_me/type_set.hpp"
+#include "support/get_me_exception.hpp"
+#include "support/ranges/functional.hpp"
 #include "support/ranges/ranges.hpp" // IWYU pragma: keep
 #include "support/variant.hpp"
 
 namespace {
+// fixpoint of the acquisition costs, every round lowers the cost of at least
+// one type or terminates
+[[nodiscard]] std::vector<size_t>
+computeAcquisitionCosts(const std::vector<InternedTransitionType> &Transitions,
+                        const std::vector<TypeIdSet> &Conversions) {
+  auto Costs = std::vector<size_t>(Conversions.size(),
+                                   UnreachableAcquisitionCost);
+  auto Changed = true;
+  const auto Relax = [&Costs, &Conversions,
+                      &Changed](const InternedTransitionType &Transition) {
+    const auto RequiredCost = ranges::fold_left(
+        ToRequired(Transition) | ranges::views::transform(Lookup(Costs)),
+        size_t{0U}, ranges::max);
+    if (RequiredCost == UnreachableAcquisitionCost) {
+      return;
+    }
+    ranges::for_each(Conversions[ToAcquired(Transition)],
+                     [&Costs, &Changed,
+                      Cost = RequiredCost + 1U](const TypeId Provided) {
+                       if (Cost < Costs[Provided]) {
+                         Costs[Provided] = Cost;
+                         Changed = true;
+                       }
+                     });
+  };
+  while (Changed) {
+    Changed = false;
+    ranges::for_each(Transitions, Relax);
+  }
+  return Costs;
+}
+
 [[nodiscard]] std::string getTypeAsString(const clang::ValueDecl *const VDecl) {
   return VDecl->getType().getAsString();
 }
@@ -75,13 +125,20 @@ constexpr auto DeclaratorDeclToString =
 } // namespace
 
 std::string getTransitionName(const TransitionDataType &Data) {
-  return std::visit(DeclaratorDeclToString, Data);
+  return std::visit(Overloaded{DeclaratorDeclToString,
+                               [](const IndexedDecl *const IDecl) {
+                                 return std::string{IDecl->Name};
+                               }},
+                    Data);
 }
 
 std::string getTransitionAcquiredTypeNames(const TransitionDataType &Data) {
   return std::visit(Overloaded{FunctionDeclToStringForAcquired,
                                [](const clang::ValueDecl *const VDecl) {
                                  return getTypeAsString(VDecl);
+                               },
+                               [](const IndexedDecl *const IDecl) {
+                                 return std::string{IDecl->AcquiredTypeNames};
                                }},
                     Data);
 }
@@ -94,6 +151,26 @@ std::string getTransitionRequiredTypeNames(const TransitionDataType &Data) {
                  },
                  [](const clang::VarDecl *const /*VDecl*/) -> std::string {
                    return "";
+                 },
+                 [](const IndexedDecl *const IDecl) {
+                   return std::string{IDecl->RequiredTypeNames};
+                 }},
+      Data);
+}
+
+std::string getTransitionUSR(const TransitionDataType &Data) {
+  return std::visit(
+      Overloaded{[](const clang::Decl *const Decl) {
+                   auto USR = llvm::SmallString<128>{};
+                   if (clang::index::generateUSRForDecl(Decl, USR)) {
+                     // no USR available, fall back to the identity of the
+                     // declaration
+                     return fmt::format("{}", static_cast<const void *>(Decl));
+                   }
+                   return USR.str().str();
+                 },
+                 [](const IndexedDecl *const IDecl) {
+                   return std::string{IDecl->USR};
                  }},
       Data);
 }
@@ -105,24 +182,108 @@ void TransitionData::commit() {
                        ranges::views::join |
                        ranges::views::transform(ToTransitionIndex),
                    [Counter = size_t{0U}]() mutable { return Counter++; });
-  BundeledData =
-      Data | ranges::views::transform([](const TransitionType &Transitions) {
-        return BundeledTransitionType{
-            {ToAcquired(Transitions), ToRequired(Transitions)},
-            ToTransitions(Transitions)};
+  auto CollectedTypes = std::vector<TransparentType>{};
+  ranges::for_each(Data | ranges::views::keys,
+                   [&CollectedTypes](const TransitionType::first_type &Key) {
+                     CollectedTypes.push_back(ToAcquired(Key));
+                     ranges::push_back(CollectedTypes, ToRequired(Key));
+                   });
+  ranges::for_each(ConversionMap | ranges::views::values,
+                   [&CollectedTypes](const TypeSet &Conversions) {
+                     ranges::push_back(CollectedTypes, Conversions);
+                   });
+  Types = CollectedTypes | ranges::to<TypeSet> | ranges::to_vector;
+
+  InternedData =
+      Data | ranges::views::transform([this](const TransitionType &Transition) {
+        return InternedTransitionType{getTypeId(ToAcquired(Transition)),
+                                      getTypeIds(ToRequired(Transition)),
+                                      ToBundeledTransitionIndex(Transition)};
+      }) |
+      ranges::to_vector;
+
+  InternedConversions =
+      Types | ranges::views::transform([this](const TransparentType &Val) {
+        const auto Conversions = ConversionMap.find(Val.Desugared);
+        if (Conversions == ConversionMap.end()) {
+          return TypeIdSet{};
+        }
+        return getTypeIds(Conversions->second);
       }) |
-      ranges::to<bundeled_container_type>;
+      ranges::to_vector;
 
-  FlatData =
-      Data | ranges::views::for_each([](const TransitionType &Transitions) {
-        return ToTransitions(Transitions) |
-               ranges::views::transform(ToTransition) |
+  const auto AcquiredAndConvertibleTypePairs =
+      ranges::views::indices(Types.size()) |
+      ranges::views::for_each([this](const size_t Convertible) {
+        return InternedConversions[Convertible] |
                ranges::views::transform(
-                   [Acquired = ToAcquired(Transitions),
-                    Required = ToRequired(Transitions)](
-                       const TransitionDataType &Transition) {
-                     return FlatTransitionType{Acquired, Transition, Required};
+                   [Convertible = static_cast<TypeId>(Convertible)](
+                       const TypeId Acquired) {
+                     return std::pair{Acquired, Convertible};
                    });
       }) |
-      ranges::to<flat_container_type>;
+      ranges::to_vector | ranges::actions::sort;
+  ReverseConversions = AcquiredAndConvertibleTypePairs |
+                       ranges::views::values | ranges::to_vector;
+  ReverseConversionOffsets =
+      ranges::views::indices(Types.size() + 1U) |
+      ranges::views::transform(
+          [&AcquiredAndConvertibleTypePairs](const size_t Acquired) {
+            return static_cast<size_t>(ranges::distance(
+                AcquiredAndConvertibleTypePairs.begin(),
+                ranges::lower_bound(AcquiredAndConvertibleTypePairs,
+                                    static_cast<TypeId>(Acquired),
+                                    std::less<>{}, Element<0>)));
+          }) |
+      ranges::to_vector;
+
+  AcquisitionCosts = computeAcquisitionCosts(InternedData, InternedConversions);
+  NameIndex = TypeNameIndex{ConversionMap};
+}
+
+const TransitionType &
+TransitionData::getBundle(const size_t BundleIndex) const {
+  return *Data.nth(BundleIndex);
+}
+
+size_t TransitionData::getNumTransitions() const {
+  return ranges::fold_left(Data | ranges::views::transform(ToTransitions) |
+                               ranges::views::transform(ranges::size),
+                           size_t{0U}, std::plus{});
+}
+
+TypeId TransitionData::getTypeId(const TransparentType &Val) const {
+  const auto Iter = ranges::lower_bound(Types, Val, std::less<>{});
+  GetMeException::verify(Iter != Types.end() && !(Val < *Iter),
+                         "getTypeId(): {} is not an interned type", Val);
+  return static_cast<TypeId>(ranges::distance(Types.begin(), Iter));
+}
+
+TypeIdSet TransitionData::getTypeIds(const TypeSet &Val) const {
+  // the ids are ordered like the types, the ids are inserted in ascending order
+  return Val | ranges::views::transform([this](const TransparentType &Element) {
+           return getTypeId(Element);
+         }) |
+         ranges::to<TypeIdSet>;
+}
+
+std::span<const TypeId>
+TransitionData::getReverseConversions(const TypeId Acquired) const {
+  return std::span{ReverseConversions}.subspan(
+      ReverseConversionOffsets[Acquired],
+      ReverseConversionOffsets[Acquired + 1U] -
+          ReverseConversionOffsets[Acquired]);
+}
+
+size_t TransitionData::getAcquisitionCost(const TypeIdSet &Val) const {
+  return ranges::fold_left(
+      Val | ranges::views::transform(Lookup(AcquisitionCosts)), size_t{0U},
+      ranges::max);
+}
+
+TypeSet TransitionData::getTypes(const TypeIdSet &Val) const {
+  const auto TypesOfIds =
+      Val | ranges::views::transform(Lookup(Types)) | ranges::to_vector;
+  return TypeSet{boost::container::ordered_unique_range, TypesOfIds.begin(),
+                 TypesOfIds.end()};
 }
@@ -0,0 +1,235 @@
+#include "get_me/type_id_set.hpp"
+
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+
+#include <range/v3/algorithm/lower_bound.hpp>
+#include <range/v3/algorithm/mismatch.hpp>
+#include <range/v3/numeric/accumulate.hpp>
+#include <range/v3/view/transform.hpp>
+
+namespace {
+using Block = TypeIdSet::Block;
+using BlockContainer = TypeIdSet::BlockContainer;
+
+[[nodiscard]] constexpr std::uint32_t toBlockIndex(const TypeId Id) noexcept {
+  return Id / TypeIdSet::BitsPerBlock;
+}
+
+[[nodiscard]] constexpr std::uint64_t toBit(const TypeId Id) noexcept {
+  return std::uint64_t{1U} << (Id % TypeIdSet::BitsPerBlock);
+}
+
+[[nodiscard]] auto findBlock(auto &Blocks, const std::uint32_t BlockIndex) {
+  return ranges::lower_bound(Blocks, BlockIndex, std::less<>{}, &Block::Index);
+}
+
+// splitmix64 finalizer
+[[nodiscard]] constexpr std::uint64_t hashId(const TypeId Id) noexcept {
+  auto Hash = std::uint64_t{Id} + 0x9E3779B97F4A7C15U;
+  Hash = (Hash ^ (Hash >> 30U)) * 0xBF58476D1CE4E5B9U;
+  Hash = (Hash ^ (Hash >> 27U)) * 0x94D049BB133111EBU;
+  return Hash ^ (Hash >> 31U);
+}
+
+// the combined hash of the ids of Bits in the block BlockIndex
+[[nodiscard]] std::uint64_t hashBits(const std::uint32_t BlockIndex,
+                                     std::uint64_t Bits) noexcept {
+  auto Hash = std::uint64_t{0U};
+  while (Bits != 0U) {
+    Hash ^= hashId((BlockIndex * TypeIdSet::BitsPerBlock) +
+                   static_cast<TypeId>(std::countr_zero(Bits)));
+    Bits &= Bits - 1U;
+  }
+  return Hash;
+}
+
+void appendIfNotEmpty(BlockContainer &Blocks, const std::uint32_t BlockIndex,
+                      const std::uint64_t Bits) {
+  if (Bits != 0U) {
+    Blocks.push_back({BlockIndex, Bits});
+  }
+}
+} // namespace
+
+TypeIdSet::size_type TypeIdSet::size() const noexcept {
+  return ranges::accumulate(Blocks_ | ranges::views::transform(
+                                          [](const Block &Val) -> size_type {
+                                            return std::popcount(Val.Bits);
+                                          }),
+                            size_type{0U});
+}
+
+bool TypeIdSet::contains(const TypeId Id) const noexcept {
+  const auto BlockIndex = toBlockIndex(Id);
+  const auto Iter = findBlock(Blocks_, BlockIndex);
+  return Iter != Blocks_.end() && Iter->Index == BlockIndex &&
+         (Iter->Bits & toBit(Id)) != 0U;
+}
+
+bool TypeIdSet::insert(const TypeId Id) {
+  const auto BlockIndex = toBlockIndex(Id);
+  // ids are mostly inserted in ascending order
+  if (Blocks_.empty() || Blocks_.back().Index < BlockIndex) {
+    Blocks_.push_back({BlockIndex, toBit(Id)});
+    Hash_ ^= hashId(Id);
+    return true;
+  }
+  const auto Iter = findBlock(Blocks_, BlockIndex);
+  if (Iter == Blocks_.end() || Iter->Index != BlockIndex) {
+    Blocks_.insert(Iter, Block{BlockIndex, toBit(Id)});
+    Hash_ ^= hashId(Id);
+    return true;
+  }
+  if ((Iter->Bits & toBit(Id)) != 0U) {
+    return false;
+  }
+  Iter->Bits |= toBit(Id);
+  Hash_ ^= hashId(Id);
+  return true;
+}
+
+bool TypeIdSet::erase(const TypeId Id) {
+  const auto BlockIndex = toBlockIndex(Id);
+  const auto Iter = findBlock(Blocks_, BlockIndex);
+  if (Iter == Blocks_.end() || Iter->Index != BlockIndex ||
+      (Iter->Bits & toBit(Id)) == 0U) {
+    return false;
+  }
+  Iter->Bits &= ~toBit(Id);
+  Hash_ ^= hashId(Id);
+  if (Iter->Bits == 0U) {
+    Blocks_.erase(Iter);
+  }
+  return true;
+}
+
+TypeIdSet setDifference(const TypeIdSet &Lhs, const TypeIdSet &Rhs) {
+  auto Result = TypeIdSet{};
+  Result.Blocks_.reserve(Lhs.Blocks_.size());
+  Result.Hash_ = Lhs.Hash_;
+  auto LhsIter = Lhs.Blocks_.begin();
+  auto RhsIter = Rhs.Blocks_.begin();
+  while (LhsIter != Lhs.Blocks_.end()) {
+    if (RhsIter == Rhs.Blocks_.end() || LhsIter->Index < RhsIter->Index) {
+      Result.Blocks_.push_back(*LhsIter);
+      ++LhsIter;
+    } else if (RhsIter->Index < LhsIter->Index) {
+      ++RhsIter;
+    } else {
+      appendIfNotEmpty(Result.Blocks_, LhsIter->Index,
+                       LhsIter->Bits & ~RhsIter->Bits);
+      Result.Hash_ ^= hashBits(LhsIter->Index, LhsIter->Bits & RhsIter->Bits);
+      ++LhsIter;
+      ++RhsIter;
+    }
+  }
+  return Result;
+}
+
+TypeIdSet setUnion(const TypeIdSet &Lhs, const TypeIdSet &Rhs) {
+  auto Result = TypeIdSet{};
+  Result.Blocks_.reserve(Lhs.Blocks_.size() + Rhs.Blocks_.size());
+  Result.Hash_ = Lhs.Hash_;
+  auto LhsIter = Lhs.Blocks_.begin();
+  auto RhsIter = Rhs.Blocks_.begin();
+  while (LhsIter != Lhs.Blocks_.end() || RhsIter != Rhs.Blocks_.end()) {
+    if (RhsIter == Rhs.Blocks_.end() ||
+        (LhsIter != Lhs.Blocks_.end() && LhsIter->Index < RhsIter->Index)) {
+      Result.Blocks_.push_back(*LhsIter);
+      ++LhsIter;
+    } else if (LhsIter == Lhs.Blocks_.end() ||
+               RhsIter->Index < LhsIter->Index) {
+      Result.Blocks_.push_back(*RhsIter);
+      Result.Hash_ ^= hashBits(RhsIter->Index, RhsIter->Bits);
+      ++RhsIter;
+    } else {
+      Result.Blocks_.push_back(
+          {LhsIter->Index, LhsIter->Bits | RhsIter->Bits});
+      Result.Hash_ ^=
+          hashBits(LhsIter->Index, RhsIter->Bits & ~LhsIter->Bits);
+      ++LhsIter;
+      ++RhsIter;
+    }
+  }
+  return Result;
+}
+
+TypeIdSet setDifferenceAndUnion(const TypeIdSet &Lhs, const TypeIdSet &Removed,
+                                const TypeIdSet &Added) {
+  return setUnion(setDifference(Lhs, Removed), Added);
+}
+
+bool isSubset(const TypeIdSet &Subset, const TypeIdSet &Superset) noexcept {
+  auto SupersetIter = Superset.Blocks_.begin();
+  auto SubsetIter = Subset.Blocks_.begin();
+  while (SubsetIter != Subset.Blocks_.end()) {
+    while (SupersetIter != Superset.Blocks_.end() &&
+           SupersetIter->Index < SubsetIter->Index) {
+      ++SupersetIter;
+    }
+    if (SupersetIter == Superset.Blocks_.end() ||
+        SupersetIter->Index != SubsetIter->Index ||
+        (SubsetIter->Bits & ~SupersetIter->Bits) != 0U) {
+      return false;
+    }
+    ++SubsetIter;
+  }
+  return true;
+}
+
+bool intersects(const TypeIdSet &Lhs, const TypeIdSet &Rhs) noexcept {
+  auto LhsIter = Lhs.Blocks_.begin();
+  auto RhsIter = Rhs.Blocks_.begin();
+  while (LhsIter != Lhs.Blocks_.end() && RhsIter != Rhs.Blocks_.end()) {
+    if (LhsIter->Index < RhsIter->Index) {
+      ++LhsIter;
+    } else if (RhsIter->Index < LhsIter->Index) {
+      ++RhsIter;
+    } else {
+      if ((LhsIter->Bits & RhsIter->Bits) != 0U) {
+        return true;
+      }
+      ++LhsIter;
+      ++RhsIter;
+    }
+  }
+  return false;
+}
+
+std::strong_ordering operator<=>(const TypeIdSet &Lhs,
+                                 const TypeIdSet &Rhs) noexcept {
+  const auto [LhsMismatch, RhsMismatch] =
+      ranges::mismatch(Lhs.Blocks_, Rhs.Blocks_);
+  const auto LhsEnded = LhsMismatch == Lhs.Blocks_.end();
+  const auto RhsEnded = RhsMismatch == Rhs.Blocks_.end();
+  if (LhsEnded || RhsEnded) {
+    // one is a prefix of the other
+    return RhsEnded <=> LhsEnded;
+  }
+  if (LhsMismatch->Index != RhsMismatch->Index) {
+    // the set with the smaller block index has the smaller next id
+    return LhsMismatch->Index <=> RhsMismatch->Index;
+  }
+
+  // both sets agree on all ids below the lowest differing bit, the set that
+  // contains it is smaller, unless the other set has no further ids and is
+  // therefore a prefix
+  const auto Difference = LhsMismatch->Bits ^ RhsMismatch->Bits;
+  const auto LowestDifference = Difference & (~Difference + 1U);
+  const auto LhsContainsLowestDifference =
+      (LhsMismatch->Bits & LowestDifference) != 0U;
+  const auto Other =
+      LhsContainsLowestDifference ? RhsMismatch : LhsMismatch;
+  const auto OtherEnd =
+      LhsContainsLowestDifference ? Rhs.Blocks_.end() : Lhs.Blocks_.end();
+  const auto OtherContinues = (Other->Bits & ~(LowestDifference - 1U)) != 0U ||
+                              std::next(Other) != OtherEnd;
+  return (LhsContainsLowestDifference == OtherContinues)
+             ? std::strong_ordering::less
+             : std::strong_ordering::greater;
+}
@@ -0,0 +1,140 @@
+#include "get_me/type_name_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+#include <range/v3/action/sort.hpp>
+#include <range/v3/action/unique.hpp>
+#include <range/v3/algorithm/fold_left.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/algorithm/lower_bound.hpp>
+#include <range/v3/algorithm/min_element.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/concat.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/indices.hpp>
+#include <range/v3/view/map.hpp>
+#include <range/v3/view/set_algorithm.hpp>
+#include <range/v3/view/subrange.hpp>
+#include <range/v3/view/take.hpp>
+#include <range/v3/view/take_while.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/type_conversion_map.hpp"
+#include "get_me/type_set.hpp"
+#include "support/ranges/functional.hpp"
+
+namespace {
+constexpr std::size_t TrigramSize = 3U;
+
+[[nodiscard]] std::uint32_t getTrigram(const std::string_view Str,
+                                       const std::size_t Position) {
+  return ranges::fold_left(
+      Str.substr(Position, TrigramSize), std::uint32_t{0U},
+      [](const std::uint32_t Trigram, const char Character) {
+        return (Trigram << 8U) | static_cast<unsigned char>(Character);
+      });
+}
+
+[[nodiscard]] auto getTrigrams(const std::string_view Str) {
+  return ranges::views::indices(Str.size() < TrigramSize
+                                    ? std::size_t{0U}
+                                    : Str.size() - TrigramSize + 1U) |
+         ranges::views::transform([Str](const std::size_t Position) {
+           return getTrigram(Str, Position);
+         });
+}
+} // namespace
+
+TypeNameIndex::TypeNameIndex(const TypeConversionMap &ConversionMap) {
+  // the first entry of a name is kept, like a search in the order of the map
+  ranges::for_each(
+      ConversionMap, [this](const TypeConversionMap::value_type &Conversion) {
+        ranges::for_each(Conversion.second,
+                         [this, &Conversion](const TransparentType &Val) {
+                           ActualNames_.emplace(fmt::format("{}", Val.Actual),
+                                                Conversion.first);
+                           DesugaredNames_.emplace(
+                               fmt::format("{}", Val.Desugared),
+                               Conversion.first);
+                         });
+      });
+
+  Names_ = ranges::views::concat(ActualNames_ | ranges::views::keys,
+                                 DesugaredNames_ | ranges::views::keys) |
+           ranges::to<std::vector<std::string>> | ranges::actions::sort |
+           ranges::actions::unique;
+  ranges::for_each(ranges::views::indices(Names_.size()),
+                   [this](const std::size_t NameIndex) {
+                     ranges::for_each(
+                         getTrigrams(Names_[NameIndex]),
+                         [this, NameIndex](const std::uint32_t Trigram) {
+                           auto &Names = NamesWithTrigram_[Trigram];
+                           if (Names.empty() || Names.back() != NameIndex) {
+                             Names.push_back(NameIndex);
+                           }
+                         });
+                   });
+}
+
+std::optional<Type> TypeNameIndex::find(const std::string_view Name) const {
+  const auto Key = std::string{Name};
+  if (const auto Iter = ActualNames_.find(Key); Iter != ActualNames_.end()) {
+    return Iter->second;
+  }
+  if (const auto Iter = DesugaredNames_.find(Key);
+      Iter != DesugaredNames_.end()) {
+    return Iter->second;
+  }
+  return std::nullopt;
+}
+
+std::vector<std::string>
+TypeNameIndex::findPrefixMatches(const std::string_view Prefix,
+                                 const std::size_t MaxCount) const {
+  return ranges::subrange(ranges::lower_bound(Names_, Prefix, std::less<>{}),
+                          Names_.end()) |
+         ranges::views::take_while([Prefix](const std::string &Name) {
+           return Name.starts_with(Prefix);
+         }) |
+         ranges::views::take(MaxCount) | ranges::to_vector;
+}
+
+std::vector<std::string>
+TypeNameIndex::findPartialMatches(const std::string_view Partial,
+                                  const std::size_t MaxCount) const {
+  if (Partial.size() < TrigramSize) {
+    return findPrefixMatches(Partial, MaxCount);
+  }
+
+  const auto EmptyNames = std::vector<std::size_t>{};
+  const auto GetNames =
+      [this, &EmptyNames](
+          const std::uint32_t Trigram) -> const std::vector<std::size_t> & {
+    const auto Iter = NamesWithTrigram_.find(Trigram);
+    return Iter == NamesWithTrigram_.end() ? EmptyNames : Iter->second;
+  };
+  const auto Trigrams = getTrigrams(Partial) | ranges::to_vector;
+  // intersect starting with the rarest trigram
+  const auto Candidates = ranges::fold_left(
+      Trigrams, GetNames(*ranges::min_element(Trigrams, std::less{},
+                                              [&GetNames](const auto Trigram) {
+                                                return GetNames(Trigram).size();
+                                              })),
+      [&GetNames](const std::vector<std::size_t> &Names,
+                  const std::uint32_t Trigram) {
+        return ranges::views::set_intersection(Names, GetNames(Trigram)) |
+               ranges::to_vector;
+      });
+  return Candidates | ranges::views::transform(Lookup(Names_)) |
+         ranges::views::filter([Partial](const std::string &Name) {
+           return Name.find(Partial) != std::string::npos;
+         }) |
+         ranges::views::take(MaxCount) | ranges::to_vector;
+}
@@ -0,0 +1,127 @@
+#ifndef get_me_lib_server_include_server_server_hpp
+#define get_me_lib_server_include_server_server_hpp
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/container/flat_set.hpp>
+#include <clang/Frontend/ASTUnit.h>
+#include <oneapi/tbb/task_group.h>
+
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/transitions.hpp"
+
+namespace llvm::json {
+class Object;
+class Value;
+} // namespace llvm::json
+
+// the transitions a QueryServer answers queries with, and the ASTs they
+// refer to (empty for transitions loaded from an index or detached from their
+// ASTs)
+struct LoadedTransitions {
+  std::vector<std::unique_ptr<clang::ASTUnit>> ASTs;
+  std::shared_ptr<TransitionData> Transitions;
+};
+
+// parses the sources or loads an index, called on construction and for every
+// reload request
+using TransitionLoader = std::function<LoadedTransitions()>;
+
+// keeps the transitions resident and answers queries over a Unix domain
+// socket. Every request and response is a single line of JSON-RPC 2.0.
+// Requests without an id are notifications and are not responded to, not even
+// with an error. Batches are not supported. The methods are:
+//   query:       {"types": ["A", "B, C"]}, the queried types of a single
+//                graph, names are split like the -t option (see
+//                splitTypeNames). Responds with the report of runQuery in the
+//                layout of toJsonLine. "path_count" is only reported with the
+//                optional parameter {"count_paths": true}, counting generates
+//                every path.
+//   multi-query: {"queries": [["A"], ["B", "C"]]}, independent queries that
+//                run concurrently, "count_paths" like query. Responds with an
+//                array of reports.
+//   stats:       the number of transitions, types, requests and reloads.
+//   reload:      replaces the transitions with the result of the loader,
+//                requests that already started finish with the old ones.
+class QueryServer {
+public:
+  QueryServer(std::shared_ptr<Config> Conf, TransitionLoader Loader);
+
+  QueryServer(const QueryServer &) = delete;
+  QueryServer(QueryServer &&) = delete;
+  QueryServer &operator=(const QueryServer &) = delete;
+  QueryServer &operator=(QueryServer &&) = delete;
+  // stops serve and the connections from receiving requests, then waits for
+  // the threads of the connections and the pending requests
+  ~QueryServer();
+
+  // requests that are longer are rejected by serve without being parsed
+  static constexpr std::size_t MaxRequestLength = std::size_t{1U} << 20U;
+
+  // the response to a single request line, without the trailing newline, or
+  // std::nullopt for a notification. Failures are reported as JSON-RPC
+  // errors, this does not throw.
+  [[nodiscard]] std::optional<std::string>
+  handleRequest(std::string_view Request);
+
+  // accepts connections on a socket at SocketPath until the server is
+  // destroyed, replacing a stale socket file. The requests of all
+  // connections are handled on the TBB thread pool, the responses of a
+  // connection may be sent in a different order than its requests. A request
+  // longer than MaxRequestLength is answered with an InvalidRequest error
+  // without an id.
+  void serve(const std::filesystem::path &SocketPath);
+
+private:
+  struct State {
+    LoadedTransitions Loaded;
+    // shared by all queries of these transitions if
+    // Config::EnableSharedExpansionCache is set
+    std::shared_ptr<ExpansionCache> Cache;
+    std::chrono::milliseconds LoadTime{};
+  };
+
+  [[nodiscard]] std::shared_ptr<const State> load() const;
+  [[nodiscard]] std::shared_ptr<const State> getState() const;
+
+  [[nodiscard]] llvm::json::Value
+  handleMethod(std::string_view Method, const llvm::json::Object &Params);
+
+  void serveConnection(int Connection);
+
+  std::shared_ptr<Config> Conf_;
+  TransitionLoader Loader_;
+
+  mutable std::mutex StateMutex_;
+  std::shared_ptr<const State> State_;
+  // reloads are serialized, queries continue during a reload
+  std::mutex ReloadMutex_;
+
+  std::atomic<std::size_t> NumRequests_{0U};
+  std::atomic<std::size_t> NumReloads_{0U};
+
+  // the listening socket of serve and the sockets of the open connections,
+  // shut down by the destructor, which waits until serve and the connections
+  // removed them
+  std::mutex ConnectionsMutex_;
+  std::condition_variable ConnectionsClosed_;
+  int Listener_{-1};
+  boost::container::flat_set<int> Connections_;
+  bool ShuttingDown_{};
+
+  tbb::task_group Requests_;
+};
+
+#endif
@@ -0,0 +1,500 @@
+#include "server/server.hpp"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <range/v3/algorithm/copy.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/join.hpp>
+#include <range/v3/view/transform.hpp>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/query_all.hpp"
+#include "get_me/query_report.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me/type_set.hpp"
+#include "support/get_me_exception.hpp"
+
+namespace {
+// the error codes of JSON-RPC 2.0
+enum class RequestErrorCode : std::int64_t {
+  ParseError = -32700,
+  InvalidRequest = -32600,
+  MethodNotFound = -32601,
+  InvalidParams = -32602,
+  // an exception while handling a valid request
+  ServerError = -32000,
+};
+
+// a request that can not be handled, reported as a JSON-RPC error
+class RequestError : public std::exception {
+public:
+  RequestError(const RequestErrorCode Code, std::string Message)
+      : Code_{Code},
+        Message_{std::move(Message)} {}
+
+  [[nodiscard]] const char *what() const noexcept final {
+    return Message_.c_str();
+  }
+
+  [[nodiscard]] RequestErrorCode code() const noexcept { return Code_; }
+
+private:
+  RequestErrorCode Code_;
+  std::string Message_;
+};
+
+[[nodiscard]] std::string toString(const llvm::json::Value &Val) {
+  return llvm::formatv("{0}", Val).str();
+}
+
+[[nodiscard]] std::string toResultResponse(llvm::json::Value Id,
+                                           llvm::json::Value Result) {
+  return toString(llvm::json::Object{{"jsonrpc", "2.0"},
+                                     {"id", std::move(Id)},
+                                     {"result", std::move(Result)}});
+}
+
+[[nodiscard]] std::string toErrorResponse(llvm::json::Value Id,
+                                          const RequestErrorCode Code,
+                                          std::string Message) {
+  return toString(llvm::json::Object{
+      {"jsonrpc", "2.0"},
+      {"id", std::move(Id)},
+      {"error", llvm::json::Object{{"code", static_cast<std::int64_t>(Code)},
+                                   {"message", std::move(Message)}}}});
+}
+
+// the layout of toJsonLine
+[[nodiscard]] llvm::json::Value toJson(const QueryReport &Report) {
+  return llvm::json::Object{
+      {"query", Report.Query},
+      {"path_count", static_cast<std::int64_t>(Report.PathCount)},
+      {"vertices", static_cast<std::int64_t>(Report.VertexCount)},
+      {"edges", static_cast<std::int64_t>(Report.EdgeCount)},
+      {"truncated", Report.Truncated},
+      {"timings_us",
+       llvm::json::Object{
+           {"graph_building",
+            static_cast<std::int64_t>(Report.GraphBuildingTime.count())},
+           {"path_finding",
+            static_cast<std::int64_t>(Report.PathFindingTime.count())},
+           {"ranking", static_cast<std::int64_t>(Report.RankingTime.count())}}},
+      {"paths", Report.Paths}};
+}
+
+// the queries of a list of type names, each name may contain several names
+// separated by commas like the -t option
+[[nodiscard]] std::vector<TypeSet> getQueries(const TransitionData &Transitions,
+                                              const llvm::json::Array &Types) {
+  const auto Names =
+      Types | ranges::views::transform([](const llvm::json::Value &Name) {
+        const auto Str = Name.getAsString();
+        if (!Str) {
+          throw RequestError{RequestErrorCode::InvalidParams,
+                             "type names have to be strings"};
+        }
+        return splitTypeNames(*Str);
+      }) |
+      ranges::views::join | ranges::to_vector;
+  return getQueriedTypesForInputs(Transitions, Names);
+}
+
+// the options of the queries of a request: the paths are only counted if the
+// optional parameter "count_paths" is true, as every path is generated to
+// count it
+[[nodiscard]] QueryOptions getQueryOptions(const llvm::json::Object &Params) {
+  const auto *const CountPaths = Params.get("count_paths");
+  if (CountPaths == nullptr) {
+    return QueryOptions{.CountPaths = false};
+  }
+  if (!CountPaths->getAsBoolean()) {
+    throw RequestError{RequestErrorCode::InvalidParams,
+                       "parameter 'count_paths' has to be a boolean"};
+  }
+  return QueryOptions{.CountPaths = *CountPaths->getAsBoolean()};
+}
+
+// the layout of toJsonLine, without "path_count" if the paths were not counted
+[[nodiscard]] llvm::json::Value toJson(const QueryReport &Report,
+                                       const QueryOptions Options) {
+  auto Result = toJson(Report);
+  if (!Options.CountPaths) {
+    Result.getAsObject()->erase("path_count");
+  }
+  return Result;
+}
+
+[[nodiscard]] const llvm::json::Array &
+getArrayParam(const llvm::json::Object &Params, const std::string_view Name) {
+  const auto *const Param = Params.getArray(Name);
+  if (Param == nullptr) {
+    throw RequestError{RequestErrorCode::InvalidParams,
+                       fmt::format("missing array parameter '{}'", Name)};
+  }
+  return *Param;
+}
+
+[[nodiscard]] std::string getErrorMessage(const int Error) {
+  return std::error_code{Error, std::generic_category()}.message();
+}
+
+[[nodiscard]] int openListeningSocket(const std::filesystem::path &SocketPath) {
+  auto Address = sockaddr_un{};
+  Address.sun_family = AF_UNIX;
+  const auto &Path = SocketPath.native();
+  GetMeException::verify(Path.size() < sizeof(Address.sun_path),
+                         "socket path {} is too long", Path);
+  ranges::copy(Path, static_cast<char *>(Address.sun_path));
+
+  // the socket of a previous server that was not shut down cleanly
+  auto RemoveError = std::error_code{};
+  if (std::filesystem::is_socket(SocketPath, RemoveError)) {
+    std::filesystem::remove(SocketPath, RemoveError);
+  }
+
+  const auto Socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  GetMeException::verify(Socket != -1, "could not create a socket: {}",
+                         getErrorMessage(errno));
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (::bind(Socket, reinterpret_cast<const sockaddr *>(&Address),
+             sizeof(Address)) != 0 ||
+      ::listen(Socket, SOMAXCONN) != 0) {
+    const auto Error = errno;
+    ::close(Socket);
+    GetMeException::fail("could not listen on {}: {}", Path,
+                         getErrorMessage(Error));
+  }
+  return Socket;
+}
+
+// a connected socket, closed once the last pending response was sent
+class Connection {
+public:
+  explicit Connection(const int Socket)
+      : Socket_{Socket} {}
+
+  Connection(const Connection &) = delete;
+  Connection(Connection &&) = delete;
+  Connection &operator=(const Connection &) = delete;
+  Connection &operator=(Connection &&) = delete;
+  ~Connection() { ::close(Socket_); }
+
+  // sends Line followed by a newline, concurrent sends do not interleave. A
+  // peer that closed the connection does not receive the line.
+  void send(std::string Line) {
+    Line += '\n';
+    const auto Lock = std::scoped_lock{SendMutex_};
+    auto Remaining = std::string_view{Line};
+    while (!Remaining.empty()) {
+      const auto NumSent =
+          ::send(Socket_, Remaining.data(), Remaining.size(), MSG_NOSIGNAL);
+      if (NumSent < 0 && errno == EINTR) {
+        continue;
+      }
+      if (NumSent < 0) {
+        spdlog::warn("could not send a response: {}", getErrorMessage(errno));
+        return;
+      }
+      Remaining.remove_prefix(static_cast<std::size_t>(NumSent));
+    }
+  }
+
+  [[nodiscard]] int socket() const noexcept { return Socket_; }
+
+private:
+  int Socket_;
+  std::mutex SendMutex_;
+};
+} // namespace
+
+QueryServer::QueryServer(std::shared_ptr<Config> Conf, TransitionLoader Loader)
+    : Conf_{std::move(Conf)},
+      Loader_{std::move(Loader)},
+      State_{load()} {}
+
+QueryServer::~QueryServer() {
+  {
+    auto Lock = std::unique_lock{ConnectionsMutex_};
+    ShuttingDown_ = true;
+    // accept fails on a listening socket that was shut down
+    if (Listener_ != -1) {
+      ::shutdown(Listener_, SHUT_RDWR);
+    }
+    // the connections stop receiving requests, the responses of their
+    // pending requests are still sent
+    ranges::for_each(Connections_, [](const int Socket) {
+      ::shutdown(Socket, SHUT_RD);
+    });
+    ConnectionsClosed_.wait(Lock, [this]() {
+      return Listener_ == -1 && Connections_.empty();
+    });
+  }
+  Requests_.wait();
+}
+
+std::shared_ptr<const QueryServer::State> QueryServer::load() const {
+  const auto Start = std::chrono::steady_clock::now();
+  auto Loaded = Loader_();
+  GetMeException::verify(Loaded.Transitions != nullptr,
+                         "no transitions were loaded");
+  auto Cache = Conf_->EnableSharedExpansionCache
+                   ? std::make_shared<ExpansionCache>(Loaded.Transitions)
+                   : std::shared_ptr<ExpansionCache>{};
+  const auto LoadTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - Start);
+  spdlog::info("Loaded {} transitions in {}ms",
+               Loaded.Transitions->getNumTransitions(), LoadTime.count());
+  return std::make_shared<const State>(
+      State{std::move(Loaded), std::move(Cache), LoadTime});
+}
+
+std::shared_ptr<const QueryServer::State> QueryServer::getState() const {
+  const auto Lock = std::scoped_lock{StateMutex_};
+  return State_;
+}
+
+std::optional<std::string>
+QueryServer::handleRequest(const std::string_view Request) {
+  ++NumRequests_;
+  auto Parsed = llvm::json::parse(Request);
+  if (!Parsed) {
+    return toErrorResponse(nullptr, RequestErrorCode::ParseError,
+                           llvm::toString(Parsed.takeError()));
+  }
+  const auto *const Object = Parsed->getAsObject();
+  if (Object == nullptr) {
+    return toErrorResponse(nullptr, RequestErrorCode::InvalidRequest,
+                           "the request is not an object");
+  }
+  const auto *const IdPtr = Object->get("id");
+  auto Id = IdPtr == nullptr ? llvm::json::Value{nullptr} : *IdPtr;
+  if (Object->getString("jsonrpc") != "2.0") {
+    return toErrorResponse(std::move(Id), RequestErrorCode::InvalidRequest,
+                           "the request is not a JSON-RPC 2.0 request");
+  }
+  const auto Method = Object->getString("method");
+  if (!Method) {
+    return toErrorResponse(std::move(Id), RequestErrorCode::InvalidRequest,
+                           "the request has no method");
+  }
+
+  // a notification, its result and errors are not reported
+  const auto IsNotification = IdPtr == nullptr;
+  const auto NoParams = llvm::json::Object{};
+  const auto *const Params = Object->getObject("params");
+  auto Response = std::string{};
+  try {
+    Response = toResultResponse(
+        Id, handleMethod(*Method, Params == nullptr ? NoParams : *Params));
+  } catch (const RequestError &Error) {
+    Response = toErrorResponse(std::move(Id), Error.code(), Error.what());
+  } catch (const GetMeException &Exception) {
+    Response = toErrorResponse(std::move(Id), RequestErrorCode::ServerError,
+                               Exception.message());
+  } catch (const std::exception &Exception) {
+    Response = toErrorResponse(std::move(Id), RequestErrorCode::ServerError,
+                               Exception.what());
+  }
+  if (IsNotification) {
+    return std::nullopt;
+  }
+  return Response;
+}
+
+llvm::json::Value QueryServer::handleMethod(const std::string_view Method,
+                                            const llvm::json::Object &Params) {
+  if (Method == "query") {
+    const auto State = getState();
+    const auto Queries = getQueries(*State->Loaded.Transitions,
+                                    getArrayParam(Params, "types"));
+    const auto Options = getQueryOptions(Params);
+    return toJson(runQuery(State->Loaded.Transitions, Queries, Conf_,
+                           State->Cache, Options),
+                  Options);
+  }
+
+  if (Method == "multi-query") {
+    const auto State = getState();
+    const auto Queries =
+        getArrayParam(Params, "queries") |
+        ranges::views::transform([&State](const llvm::json::Value &Query) {
+          const auto *const Types = Query.getAsArray();
+          if (Types == nullptr) {
+            throw RequestError{RequestErrorCode::InvalidParams,
+                               "every query has to be an array of type names"};
+          }
+          return getQueries(*State->Loaded.Transitions, *Types);
+        }) |
+        ranges::to_vector;
+    const auto Options = getQueryOptions(Params);
+
+    auto Reports = std::vector<QueryReport>(Queries.size());
+    tbb::parallel_for(size_t{0U}, Queries.size(),
+                      [this, &State, &Queries, &Reports,
+                       Options](const size_t Index) {
+                        Reports[Index] =
+                            runQuery(State->Loaded.Transitions, Queries[Index],
+                                     Conf_, State->Cache, Options);
+                      });
+    auto Result = llvm::json::Array{};
+    ranges::for_each(Reports, [&Result, Options](const QueryReport &Report) {
+      Result.push_back(toJson(Report, Options));
+    });
+    return Result;
+  }
+
+  if (Method == "stats") {
+    const auto State = getState();
+    return llvm::json::Object{
+        {"transitions", static_cast<std::int64_t>(
+                            State->Loaded.Transitions->getNumTransitions())},
+        {"types",
+         static_cast<std::int64_t>(State->Loaded.Transitions->Types.size())},
+        {"requests", static_cast<std::int64_t>(NumRequests_.load())},
+        {"reloads", static_cast<std::int64_t>(NumReloads_.load())},
+        {"load_time_ms", static_cast<std::int64_t>(State->LoadTime.count())}};
+  }
+
+  if (Method == "reload") {
+    const auto ReloadLock = std::scoped_lock{ReloadMutex_};
+    auto NewState = load();
+    const auto NumTransitions =
+        NewState->Loaded.Transitions->getNumTransitions();
+    const auto LoadTime = NewState->LoadTime;
+    {
+      const auto Lock = std::scoped_lock{StateMutex_};
+      State_ = std::move(NewState);
+    }
+    ++NumReloads_;
+    return llvm::json::Object{
+        {"transitions", static_cast<std::int64_t>(NumTransitions)},
+        {"load_time_ms", static_cast<std::int64_t>(LoadTime.count())}};
+  }
+
+  throw RequestError{RequestErrorCode::MethodNotFound,
+                     fmt::format("unknown method '{}'", Method)};
+}
+
+void QueryServer::serveConnection(const int Socket) {
+  const auto Conn = std::make_shared<Connection>(Socket);
+  auto Buffer = std::array<char, 4096>{};
+  // the received bytes after the last complete line
+  auto Pending = std::string{};
+  // whether the rest of a line longer than MaxRequestLength is dropped until
+  // its end is received
+  auto DropsLine = false;
+  const auto RejectTooLong = [&Conn]() {
+    Conn->send(toErrorResponse(
+        nullptr, RequestErrorCode::InvalidRequest,
+        fmt::format("the request is longer than {} bytes", MaxRequestLength)));
+  };
+  while (true) {
+    const auto NumReceived =
+        ::recv(Conn->socket(), Buffer.data(), Buffer.size(), 0);
+    if (NumReceived < 0 && errno == EINTR) {
+      continue;
+    }
+    if (NumReceived <= 0) {
+      break;
+    }
+    Pending.append(Buffer.data(), static_cast<std::size_t>(NumReceived));
+
+    auto LineStart = std::size_t{0U};
+    auto LineEnd = Pending.find('\n');
+    while (LineEnd != std::string::npos) {
+      auto Line = Pending.substr(LineStart, LineEnd - LineStart);
+      // the end of a line that was already rejected is dropped
+      const auto IsDropped = std::exchange(DropsLine, false);
+      if (!IsDropped && Line.size() > MaxRequestLength) {
+        RejectTooLong();
+      } else if (!IsDropped && !Line.empty()) {
+        Requests_.run([this, Conn, Line = std::move(Line)]() {
+          if (auto Response = handleRequest(Line)) {
+            Conn->send(std::move(*Response));
+          }
+        });
+      }
+      LineStart = LineEnd + 1U;
+      LineEnd = Pending.find('\n', LineStart);
+    }
+    Pending.erase(0U, LineStart);
+
+    // an incomplete line is not buffered beyond MaxRequestLength
+    if (Pending.size() > MaxRequestLength) {
+      if (!std::exchange(DropsLine, true)) {
+        RejectTooLong();
+      }
+      Pending.clear();
+    }
+  }
+
+  // while Conn is alive, the socket can not be reused by another connection
+  // before the destructor no longer shuts it down
+  const auto Lock = std::scoped_lock{ConnectionsMutex_};
+  Connections_.erase(Socket);
+  ConnectionsClosed_.notify_all();
+}
+
+void QueryServer::serve(const std::filesystem::path &SocketPath) {
+  const auto Listener = openListeningSocket(SocketPath);
+  {
+    const auto Lock = std::scoped_lock{ConnectionsMutex_};
+    Listener_ = Listener;
+  }
+  spdlog::info("Serving queries on {}", SocketPath.native());
+  while (true) {
+    const auto Socket = ::accept4(Listener, nullptr, nullptr, SOCK_CLOEXEC);
+    const auto Error = errno;
+    auto Lock = std::unique_lock{ConnectionsMutex_};
+    if (const auto ShuttingDown = ShuttingDown_;
+        ShuttingDown ||
+        (Socket == -1 && Error != EINTR && Error != ECONNABORTED)) {
+      Listener_ = -1;
+      ConnectionsClosed_.notify_all();
+      Lock.unlock();
+      if (Socket != -1) {
+        ::close(Socket);
+      }
+      ::close(Listener);
+      GetMeException::verify(ShuttingDown,
+                             "could not accept a connection on {}: {}",
+                             SocketPath.native(), getErrorMessage(Error));
+      return;
+    }
+    if (Socket != -1) {
+      Connections_.insert(Socket);
+      // every connection blocks a thread of its own while it waits for
+      // requests, instead of a worker of the thread pool. The destructor
+      // waits until the thread removed its connection.
+      std::thread{[this, Socket]() { serveConnection(Socket); }}.detach();
+    }
+  }
+}
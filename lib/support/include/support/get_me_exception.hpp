@@ -25,6 +25,10 @@ public:
 
   [[nodiscard]] const char *what() const noexcept final { return ""; }
 
+  [[nodiscard]] const std::string &message() const noexcept {
+    return Message_;
+  }
+
   template <typename... Ts>
   static void verify(const bool Condition, const std::string_view FormatString,
                      Ts &&...Args) {
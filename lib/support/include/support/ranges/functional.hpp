@@ -44,6 +44,14 @@ inline constexpr auto SafePlus = []<std::integral T>(const T Lhs,
   return std::plus<T>{}(Lhs, Rhs);
 };
 
+inline constexpr auto SafeMultiplies = []<std::integral T>(
+                                           const T Lhs, const T Rhs) constexpr {
+  if (Lhs != T{} && Rhs > std::numeric_limits<T>::max() / Lhs) {
+    return std::numeric_limits<T>::max();
+  }
+  return std::multiplies<T>{}(Lhs, Rhs);
+};
+
 // add binary and unary support via binary facade or smt
 
 inline constexpr auto Plus = []<typename T>(T Rhs) constexpr {
@@ -0,0 +1,31 @@
+#ifndef get_me_lib_support_include_support_ranges_generator_hpp
+#define get_me_lib_support_include_support_ranges_generator_hpp
+
+#include <concepts>
+#include <optional>
+#include <utility>
+
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/view/generate.hpp>
+#include <range/v3/view/take_while.hpp>
+#include <range/v3/view/transform.hpp>
+
+template <typename T>
+concept Generator = requires(T Gen) {
+  { Gen.next().has_value() } -> std::same_as<bool>;
+};
+
+// single-pass range over the values produced by Gen.next(), ends at the first
+// std::nullopt. Values are only produced when the range is advanced, which
+// allows to stop pulling values early.
+template <Generator GeneratorType>
+[[nodiscard]] ranges::viewable_range auto toLazyRange(GeneratorType Gen) {
+  return ranges::views::generate(
+             [Gen = std::move(Gen)]() mutable { return Gen.next(); }) |
+         ranges::views::take_while(
+             [](const auto &Val) { return Val.has_value(); }) |
+         ranges::views::transform(
+             [](auto &&Val) { return std::move(*Val); });
+}
+
+#endif
@@ -1,4 +1,3 @@
-#include <compare>
 #include <memory>
 #include <string>
 #include <utility>
@@ -13,15 +12,14 @@
 #include <ftxui/component/component_base.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
-#include <range/v3/action/sort.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/transform.hpp>
 
-#include "get_me/backwards_path_finding.hpp"
 #include "get_me/config.hpp"
 #include "get_me/graph.hpp"
 #include "get_me/query.hpp"
+#include "get_me/ranked_path_finding.hpp"
 #include "get_me/tooling.hpp"
 #include "get_me/transitions.hpp"
 #include "get_me/type_set.hpp"
@@ -70,10 +68,14 @@ public:
 
 private:
   void collectTransitions() {
-    const auto BuildASTsResult = Tool_.buildASTs(ASTs_);
+    // build into a fresh vector, the transitions of a previous update refer to
+    // the old ASTs until they are replaced
+    auto ASTs = std::vector<std::unique_ptr<clang::ASTUnit>>{};
+    const auto BuildASTsResult = Tool_.buildASTs(ASTs);
     GetMeException::verify(BuildASTsResult == 0, "Error building ASTs");
 
-    Transitions_ = ::collectTransitions(*ASTs_.front(), Conf_);
+    Transitions_ = ::collectTransitions(ASTs, Conf_);
+    ASTs_ = std::move(ASTs);
   }
 
   std::shared_ptr<Config> Conf_;
@@ -97,24 +99,12 @@ void runTui(const std::shared_ptr<Config> Conf,
   // initialized (aka filled)
   const auto CommitCallback = [&Conf, &PathsStr, &CollectionState,
                                &QueriedName]() {
-    const auto Query = getQueriedTypesForInput(
-        *CollectionState.getTransitionsPtr(), QueriedName);
+    const auto Queries = getQueriedTypesForInputs(
+        *CollectionState.getTransitionsPtr(), splitTypeNames(QueriedName));
 
     auto Data =
-        runGraphBuilding(CollectionState.getTransitionsPtr(), Query, Conf);
-    const auto Paths =
-        runPathFinding(Data) |
-        ranges::actions::sort([&Data](const PathType &Lhs,
-                                      const PathType &Rhs) {
-          if (const auto Comp = Lhs.size() <=> Rhs.size(); std::is_neq(Comp)) {
-            return std::is_lt(Comp);
-          }
-          if (Lhs.empty()) {
-            return true;
-          }
-          return Data.VertexData[Target(Lhs.back())].size() <
-                 Data.VertexData[Target(Rhs.back())].size();
-        });
+        runGraphBuilding(CollectionState.getTransitionsPtr(), Queries, Conf);
+    const auto Paths = runTopKPathFinding(Data, Conf->MaxPathOutputCount);
     PathsStr =
         Paths | ranges::views::enumerate |
         ranges::views::transform([&Data](const auto IndexedPath) {
@@ -127,9 +117,15 @@ void runTui(const std::shared_ptr<Config> Conf,
                           [&Data](const TransitionEdgeType &Edge) {
                             return fmt::format(
                                 "{}",
-                                ToTransitions(
-                                    Data.Transitions
-                                        ->BundeledData[Edge.TransitionIndex]));
+                                fmt::join(
+                                    Data.getEdgeTransitions(Edge) |
+                                        ranges::views::transform(
+                                            [&Data](const size_t Index) {
+                                              return ToTransitions(
+                                                  Data.Transitions->getBundle(
+                                                      Index));
+                                            }),
+                                    " | "));
                           }),
                   ", "),
               Data.VertexData[Target(Path.back())]);
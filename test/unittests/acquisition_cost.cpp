@@ -0,0 +1,69 @@
+#include <memory>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me_tests.hpp"
+
+TEST_CASE("acquisition cost") {
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct A;
+    struct B;
+    struct C;
+    struct D;
+    struct E;
+    A getA();
+    B getB(A);
+    C getC(A, B);
+    D getD(E);
+  )");
+
+  const auto GetCost = [&Transitions](const std::string_view QueriedType) {
+    return Transitions->getAcquisitionCost(Transitions->getTypeIds(
+        getQueriedTypesForInput(*Transitions, QueriedType)));
+  };
+  REQUIRE(GetCost("A") == 1U);
+  REQUIRE(GetCost("B") == 2U);
+  REQUIRE(GetCost("C") == 3U);
+  REQUIRE(GetCost("D") == UnreachableAcquisitionCost);
+
+  SECTION("pruning without remaining types") {
+    const auto Conf = std::make_shared<Config>();
+    const auto CompleteConf =
+        std::make_shared<Config>(Config{.MaxRemainingTypes = 0U});
+
+    const auto QueryD = getQueriedTypesForInput(*Transitions, "D");
+    REQUIRE_FALSE(runGraphBuilding(Transitions, QueryD, Conf).Edges.empty());
+    REQUIRE(runGraphBuilding(Transitions, QueryD, CompleteConf).Edges.empty());
+
+    const auto QueryC = getQueriedTypesForInput(*Transitions, "C");
+    REQUIRE_FALSE(
+        runGraphBuilding(Transitions, QueryC, CompleteConf).Edges.empty());
+  }
+}
+
+TEST_CASE("acquisition cost with remaining types") {
+  // Context can not be acquired, A and B both require it. Leaving Context
+  // behind acquires both of them, pruning by the acquisition costs of A and B
+  // would lose the path.
+  const auto Conf = std::make_shared<Config>(Config{.MaxRemainingTypes = 1U});
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct Context;
+    struct A { A(Context &); };
+    struct B { B(Context &); };
+    struct Q;
+    Q make(A, B);
+  )",
+                                                     Conf);
+
+  const auto Paths = buildGraphAndFindPaths(Transitions, "Q", Conf);
+  REQUIRE(ranges::any_of(Paths, [](const std::string_view Path) {
+    return Path.contains("Q make(A, B)") && Path.contains("A A(Context &)") &&
+           Path.contains("B B(Context &)");
+  }));
+}
@@ -3,6 +3,8 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
 #include "get_me_tests.hpp"
 
 TEST_CASE("simple single edges") {
@@ -268,6 +270,26 @@ TEST_CASE("dependent") {
        });
 }
 
+TEST_CASE("skip function bodies") {
+  const auto Code = R"(
+        struct A {};
+        struct B { B(A); };
+        B getB() {
+          struct Local {};
+          A Val{};
+          return B{Val};
+        }
+        )";
+  const auto Expected = ResultPaths{
+      "(B, B getB(), {})",
+      "(B, B B(A), {A}), (A, A A(), {})",
+  };
+
+  test(Code, "B", Expected);
+  test(Code, "B", Expected,
+       std::make_shared<Config>(Config{.EnableSkipFunctionBodies = true}));
+}
+
 TEST_CASE("cycles") {
   test(R"(
         struct A {};
@@ -289,3 +311,27 @@ TEST_CASE("cycles") {
            "(A, A A(), {})",
        });
 }
+
+TEST_CASE("independent transitions of a vertex") {
+  // getB requires A, which getA acquires: from {A, B} only getB is taken,
+  // getA is taken once A is the only type left
+  constexpr auto Code = R"(
+        struct A;
+        struct B;
+        struct Q;
+        A getA();
+        B getB(A);
+        Q getQ(A, B);
+        )";
+  test(Code, "Q",
+       {
+           "(Q, Q getQ(A, B), {A, B}), (B, B getB(A), {A}), (A, A getA(), {})",
+       });
+
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+  const auto Data = runGraphBuilding(
+      Transitions, getQueriedTypesForInput(*Transitions, "Q"), Conf);
+  REQUIRE(Data.VertexData.size() == 4U);
+  REQUIRE(Data.Edges.size() == 3U);
+}
@@ -0,0 +1,124 @@
+#include <memory>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+#include <range/v3/algorithm/contains.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/indices.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/ranked_path_finding.hpp"
+#include "get_me/subset_index.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me/type_id_set.hpp"
+#include "get_me/type_set.hpp"
+#include "get_me_tests.hpp"
+#include "support/testcase_generation.hpp"
+
+namespace {
+void requireNoDominatedVertices(const std::string_view Code,
+                                const std::string_view QueriedType) {
+  const auto Conf = std::make_shared<Config>();
+  const auto PruningConf =
+      std::make_shared<Config>(Config{.EnableDominancePruning = true});
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+  const auto PrunedData = runGraphBuilding(Transitions, Query, PruningConf);
+  REQUIRE(PrunedData.VertexData.size() <= Data.VertexData.size());
+  REQUIRE(PrunedData.Edges.size() <= Data.Edges.size());
+
+  const auto IsStrictSubset = [](const TypeIdSet &Subset,
+                                 const TypeIdSet &Superset) {
+    return !Subset.empty() && Subset.size() < Superset.size() &&
+           isSubset(Subset, Superset);
+  };
+  ranges::for_each(
+      ranges::views::indices(PrunedData.VertexData.size()),
+      [&](const VertexDescriptor Vertex) {
+        const auto Types =
+            Transitions->getTypeIds(PrunedData.VertexData[Vertex]);
+        REQUIRE_FALSE(ranges::any_of(
+            ranges::views::indices(PrunedData.VertexData.size()),
+            [&](const VertexDescriptor Other) {
+              // descriptors are assigned in the order vertices are added
+              return Other < Vertex && PrunedData.VertexDepth[Vertex] != 0U &&
+                     IsStrictSubset(
+                         Transitions->getTypeIds(PrunedData.VertexData[Other]),
+                         Types);
+            }));
+      });
+}
+} // namespace
+
+TEST_CASE("subset index") {
+  auto Index = SubsetIndex{};
+  Index.insert(TypeIdSet{1U, 2U});
+  Index.insert(TypeIdSet{3U});
+  Index.insert(TypeIdSet{});
+
+  REQUIRE(Index.containsStrictSubsetOf(TypeIdSet{1U, 2U, 4U}));
+  REQUIRE(Index.containsStrictSubsetOf(TypeIdSet{3U, 100U}));
+  REQUIRE_FALSE(Index.containsStrictSubsetOf(TypeIdSet{1U, 2U}));
+  REQUIRE_FALSE(Index.containsStrictSubsetOf(TypeIdSet{1U, 4U}));
+  REQUIRE_FALSE(Index.containsStrictSubsetOf(TypeIdSet{}));
+}
+
+TEST_CASE("dominance pruning") {
+  forEachGenerated(GenerateForkingPath, 5U, requireNoDominatedVertices);
+  forEachGenerated(GenerateMultiForkingPath, 5U, requireNoDominatedVertices);
+}
+
+TEST_CASE("dominance pruning of a known vertex") {
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct A;
+    struct B;
+    struct X;
+    struct Y;
+    A getA();
+    B getB();
+    X getX(A);
+    X getXFromY(Y);
+    Y getY(A, B);
+  )");
+  const auto Query = getQueriedTypesForInput(*Transitions, "X");
+  const auto ToTypeIds = [&Transitions](const std::string_view QueriedType) {
+    return Transitions->getTypeIds(
+        getQueriedTypesForInput(*Transitions, QueriedType));
+  };
+  // {A, B} is reached from {Y} after {A} was reached from {X}
+  const auto Dominated = setUnion(ToTypeIds("A"), ToTypeIds("B"));
+  const auto ContainsDominated = [&Transitions,
+                                  &Dominated](const GraphData &Data) {
+    return ranges::contains(
+        Data.VertexData |
+            ranges::views::transform([&Transitions](const TypeSet &Vertex) {
+              return Transitions->getTypeIds(Vertex);
+            }),
+        Dominated);
+  };
+
+  const auto Data =
+      runGraphBuilding(Transitions, Query, std::make_shared<Config>());
+  const auto PrunedData = runGraphBuilding(
+      Transitions, Query,
+      std::make_shared<Config>(Config{.EnableDominancePruning = true}));
+  REQUIRE(ContainsDominated(Data));
+  REQUIRE_FALSE(ContainsDominated(PrunedData));
+
+  // the shortest path, getA and getX, is kept
+  const auto ShortestPaths = runTopKPathFinding(Data, 1U);
+  const auto PrunedShortestPaths = runTopKPathFinding(PrunedData, 1U);
+  REQUIRE(ShortestPaths.size() == 1U);
+  REQUIRE(PrunedShortestPaths.size() == 1U);
+  REQUIRE(ShortestPaths.front().size() == 2U);
+  REQUIRE(PrunedShortestPaths.front().size() == 2U);
+  REQUIRE(detail::formatPath(ShortestPaths.front(), Data) ==
+          detail::formatPath(PrunedShortestPaths.front(), PrunedData));
+}
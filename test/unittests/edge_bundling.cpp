@@ -0,0 +1,102 @@
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/adjacent_find.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+#include <range/v3/algorithm/count_if.hpp>
+#include <range/v3/algorithm/equal.hpp>
+#include <range/v3/algorithm/find_if.hpp>
+#include <range/v3/algorithm/fold_left.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/ranked_path_finding.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me_tests.hpp"
+
+TEST_CASE("edge bundling") {
+  // the transitions that acquire A and B are different bundles that both
+  // lead from {B} to {}
+  const auto Conf =
+      std::make_shared<Config>(Config{.EnablePropagateTypeAlias = true});
+  const auto [AST, Transitions] = collectTransitions(R"(
+  struct A {};
+  using B = A;
+  A getA();
+  B getB();
+  )",
+                                                     Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, "B");
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+
+  REQUIRE(ranges::adjacent_find(Data.Edges, std::equal_to{},
+                                &TransitionEdgeType::Edge) == Data.Edges.end());
+  REQUIRE(Data.EdgeTransitionOffsets.size() == Data.Edges.size() + 1U);
+  REQUIRE(ranges::fold_left(
+              Data.Edges | ranges::views::transform(
+                               [&Data](const TransitionEdgeType &Edge) {
+                                 return Data.getEdgeTransitions(Edge).size();
+                               }),
+              size_t{0U}, std::plus{}) == Data.EdgeTransitions.size());
+
+  const auto Paths = runPathFinding(Data) | ranges::to_vector;
+  REQUIRE(Paths.size() == 1U);
+  REQUIRE(Data.getEdgeTransitions(Paths.front().front()).size() == 2U);
+  REQUIRE(expandAndFlattenPath(Paths.front(), Data).size() == 3U);
+}
+
+TEST_CASE("edge bundling with shared alternatives") {
+  // getA and getB are bundled on the edges {A, X} -> {X} and {A} -> {}, a
+  // path can take both edges because they can take different transitions
+  const auto Conf = std::make_shared<Config>(
+      Config{.EnablePropagateTypeAlias = true, .MaxGraphDepth = 6U,
+             .MaxPathLength = 6U});
+  const auto [AST, Transitions] = collectTransitions(R"(
+  struct A {};
+  using B = A;
+  struct X {};
+  struct Y {};
+  struct D {};
+  A getA();
+  B getB();
+  X getX(Y);
+  Y getY(A);
+  D getD(A, X);
+  )",
+                                                     Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, "D");
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+
+  const auto HasAlternatives = [&Data](const TransitionEdgeType &Edge) {
+    return Data.getEdgeTransitions(Edge).size() == 2U;
+  };
+  const auto BundledEdges =
+      Data.Edges | ranges::views::filter(HasAlternatives) | ranges::to_vector;
+  REQUIRE(BundledEdges.size() == 2U);
+  REQUIRE(ranges::equal(Data.getEdgeTransitions(BundledEdges.front()),
+                        Data.getEdgeTransitions(BundledEdges.back())));
+
+  const auto TakesBothBundledEdges = [&HasAlternatives](const PathType &Path) {
+    return ranges::count_if(Path, HasAlternatives) == 2;
+  };
+  const auto Paths = runPathFinding(Data) | ranges::to_vector;
+  REQUIRE(Paths.size() == 2U);
+  REQUIRE(ranges::any_of(Paths, TakesBothBundledEdges));
+
+  // the bundled edges take getA and getB once each, the flattened paths that
+  // take the same transition on both of them are skipped
+  const auto PathWithBothBundledEdges =
+      ranges::find_if(Paths, TakesBothBundledEdges);
+  REQUIRE(expandAndFlattenPath(*PathWithBothBundledEdges, Data).size() == 2U);
+
+  const auto RankedPaths = runTopKPathFinding(Data, 2U);
+  REQUIRE(RankedPaths.size() == 2U);
+  REQUIRE(TakesBothBundledEdges(RankedPaths.back()));
+}
@@ -20,6 +20,7 @@
 #include <get_me/graph.hpp>
 #include <get_me/tooling.hpp>
 #include <oneapi/tbb/parallel_for_each.h>
+#include <range/v3/action/push_back.hpp>
 #include <range/v3/algorithm/equal.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/set_algorithm.hpp>
@@ -68,7 +69,7 @@ void verify(const bool ExpectedEqualityResult, const auto &FoundPathsAsString,
                 Seperator)));
 
   INFO(fmt::format("{1: <{0}}: {2}", Indentation, "Transitions",
-                   fmt::join(Transitions.BundeledData, Seperator)));
+                   fmt::join(Transitions.Data, Seperator)));
   REQUIRE(ExpectedEqualityResult ==
           ranges::equal(FoundPathsAsString, ExpectedPaths));
 }
@@ -164,7 +165,11 @@ void testQueryAll(const std::string_view Code, std::shared_ptr<Config> Conf,
 
 std::pair<std::unique_ptr<clang::ASTUnit>, std::shared_ptr<TransitionData>>
 collectTransitions(const std::string_view Code, std::shared_ptr<Config> Conf) {
-  auto AST = clang::tooling::buildASTFromCodeWithArgs(Code, {"-std=c++20"});
+  auto Args = std::vector<std::string>{"-std=c++20"};
+  if (Conf) {
+    ranges::push_back(Args, getParseArguments(*Conf));
+  }
+  auto AST = clang::tooling::buildASTFromCodeWithArgs(Code, Args);
   auto Transitions = collectTransitions(*AST, std::move(Conf));
   return {std::move(AST), std::move(Transitions)};
 }
@@ -48,6 +48,34 @@ void test(std::string_view Code, std::string_view QueriedType,
           std::shared_ptr<Config> Conf = std::make_shared<Config>(),
           std::source_location Loc = std::source_location::current());
 
+// code with alternative paths through constructors, conversions and type
+// aliases, shared by the tests that compare the results of a feature with
+// the results without it
+inline constexpr auto AlternativePathsCode = std::string_view{R"(
+    struct A {};
+    struct B { explicit B(A); };
+    struct C { C(A, B); };
+    struct D {};
+    using E = C;
+    E getE(D);
+    C getC(const B &, int);
+    B getB(float);
+    A getA(D);
+    D getD();
+  )"};
+inline constexpr auto AlternativePathsQueriedType = std::string_view{"C"};
+
+// calls Check with the code and the queried type of the test cases of
+// Generator with 1 to Count - 1 repetitions
+void forEachGenerated(const auto &Generator, const size_t Count,
+                      const auto &Check) {
+  ranges::for_each(ranges::views::indices(size_t{1U}, Count),
+                   [&Generator, &Check](const size_t NumRepetitions) {
+                     const auto [QueriedType, Code] = Generator(NumRepetitions);
+                     Check(Code, QueriedType);
+                   });
+}
+
 void test(const auto &Generator, const size_t Count,
           std::shared_ptr<Config> Conf = std::make_shared<Config>(),
           std::source_location Loc = std::source_location::current()) {
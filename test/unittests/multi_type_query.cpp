@@ -0,0 +1,101 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/indices.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/ranked_path_finding.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me_tests.hpp"
+
+TEST_CASE("split type names") {
+  REQUIRE(splitTypeNames("A") == std::vector<std::string>{"A"});
+  REQUIRE(splitTypeNames(" A, B ,C") ==
+          std::vector<std::string>{"A", "B", "C"});
+  REQUIRE(splitTypeNames("std::pair<int, float>, A") ==
+          std::vector<std::string>{"std::pair<int, float>", "A"});
+  REQUIRE(splitTypeNames("void (*)(int, int),,B") ==
+          std::vector<std::string>{"void (*)(int, int)", "B"});
+  REQUIRE(splitTypeNames(" , ").empty());
+}
+
+TEST_CASE("multi type query") {
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct A;
+    struct B;
+    struct C;
+    C getC();
+    A getA(C);
+    B getB(C);
+  )",
+                                                     Conf);
+
+  const auto Queries = getQueriedTypesForInputs(*Transitions, {"A", "B"});
+  REQUIRE(Queries.size() == 2U);
+  const auto Data = runGraphBuilding(Transitions, Queries, Conf);
+
+  // every root vertex holds one type of each query
+  const auto RootVertices = ranges::views::indices(Data.VertexData.size()) |
+                            ranges::views::filter([&Data](const size_t Vertex) {
+                              return Data.VertexDepth[Vertex] == 0U;
+                            });
+  REQUIRE(ranges::all_of(RootVertices, [&Data](const size_t Vertex) {
+    return Data.VertexData[Vertex].size() == 2U;
+  }));
+
+  // getA, getB and a single getC for the C both of them require
+  const auto Paths = runTopKPathFinding(Data, 1U);
+  REQUIRE(Paths.size() == 1U);
+  REQUIRE(Paths.front().size() == 3U);
+  REQUIRE(Data.VertexData[Target(Paths.front().back())].empty());
+}
+
+TEST_CASE("multi type query keeps transitions between the queries") {
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct A;
+    struct B;
+    A getA();
+    B getB(A);
+  )",
+                                                     Conf);
+
+  const auto Queries = getQueriedTypesForInputs(*Transitions, {"A", "B"});
+  const auto Data = runGraphBuilding(Transitions, Queries, Conf);
+
+  // getB requires A, which is acquired for the other query
+  const auto Paths = runTopKPathFinding(Data, 1U);
+  REQUIRE(Paths.size() == 1U);
+  REQUIRE(Paths.front().size() == 2U);
+  REQUIRE(Data.VertexData[Target(Paths.front().back())].empty());
+}
+
+TEST_CASE("multi type query scales the depth and length limits") {
+  const auto Conf = std::make_shared<Config>(
+      Config{.MaxGraphDepth = 1U, .MaxPathLength = 1U});
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct A;
+    struct B;
+    A getA();
+    B getB();
+  )",
+                                                     Conf);
+
+  const auto Queries = getQueriedTypesForInputs(*Transitions, {"A", "B"});
+  const auto Data = runGraphBuilding(Transitions, Queries, Conf);
+  REQUIRE(Data.Conf->MaxGraphDepth == 2U);
+  REQUIRE(Data.Conf->MaxPathLength == 2U);
+  REQUIRE(Conf->MaxPathLength == 1U);
+
+  // a path acquires both types, one edge per type
+  const auto Paths = runTopKPathFinding(Data, 1U);
+  REQUIRE(Paths.size() == 1U);
+  REQUIRE(Paths.front().size() == 2U);
+}
@@ -0,0 +1,103 @@
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <fmt/core.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "get_me/config.hpp"
+#include "get_me/tooling.hpp"
+#include "get_me_tests.hpp"
+
+TEST_CASE("multiple translation units") {
+  const auto Conf = std::make_shared<Config>();
+  constexpr std::string_view Common = R"(
+    struct A { A() = delete; };
+    struct B { B() = delete; };
+    A getA();
+  )";
+
+  auto ASTs = std::vector<std::unique_ptr<clang::ASTUnit>>{};
+  ASTs.push_back(clang::tooling::buildASTFromCodeWithArgs(
+      fmt::format("{} B getB(A);", Common), {"-std=c++20"}, "first.cpp"));
+  ASTs.push_back(clang::tooling::buildASTFromCodeWithArgs(
+      fmt::format("{} B getB();", Common), {"-std=c++20"}, "second.cpp"));
+
+  const auto Transitions = collectTransitions(ASTs, Conf);
+  REQUIRE(buildGraphAndFindPaths(Transitions, "B", Conf) ==
+          ResultPaths{
+              "(B, B getB(A), {A}), (A, A getA(), {})",
+              "(B, B getB(), {})",
+          });
+
+  // declarations seen in both translation units are only collected once
+  const auto [AST, SingleTransitions] = collectTransitions(
+      fmt::format("{} B getB(A); B getB();", Common), Conf);
+  REQUIRE(Transitions->getNumTransitions() ==
+          SingleTransitions->getNumTransitions());
+}
+
+TEST_CASE("types with the same name in multiple translation units") {
+  const auto Conf = std::make_shared<Config>(Config{.MaxRemainingTypes = 0U});
+
+  // the types in the anonymous namespaces are distinct, getA does not
+  // provide the A of getB and B can not be acquired
+  auto ASTs = std::vector<std::unique_ptr<clang::ASTUnit>>{};
+  ASTs.push_back(clang::tooling::buildASTFromCodeWithArgs(
+      R"(
+    namespace { struct A { A() = delete; }; }
+    struct B { B() = delete; };
+    B getB(A);
+  )",
+      {"-std=c++20"}, "first.cpp"));
+  ASTs.push_back(clang::tooling::buildASTFromCodeWithArgs(
+      R"(
+    namespace { struct A { A() = delete; }; }
+    A getA();
+  )",
+      {"-std=c++20"}, "second.cpp"));
+
+  const auto Transitions = collectTransitions(ASTs, Conf);
+  REQUIRE(buildGraphAndFindPaths(Transitions, "B", Conf).empty());
+}
+
+TEST_CASE("multiple translation units built while collecting") {
+  const auto Conf = std::make_shared<Config>();
+  const auto WriteSource = [](const std::string_view Code) {
+    auto SourcePath = llvm::SmallString<128>{};
+    auto File = 0;
+    REQUIRE_FALSE(llvm::sys::fs::createTemporaryFile(
+        "get_me_multiple_translation_units", "cpp", File, SourcePath));
+    auto Stream = llvm::raw_fd_ostream{File, /*shouldClose=*/true};
+    Stream << Code;
+    return SourcePath.str().str();
+  };
+  constexpr std::string_view Common = R"(
+    struct A { A() = delete; };
+    struct B { B() = delete; };
+    A getA();
+  )";
+  const auto Sources = std::vector<std::string>{
+      WriteSource(fmt::format("{} B getB(A);", Common)),
+      WriteSource(fmt::format("{} B getB();", Common))};
+  const auto RemoveFirst = llvm::FileRemover{Sources[0]};
+  const auto RemoveSecond = llvm::FileRemover{Sources[1]};
+
+  const auto Compilations =
+      clang::tooling::FixedCompilationDatabase{".", {"-std=c++20"}};
+  const auto Transitions = collectTransitions(Compilations, Sources, Conf);
+  REQUIRE(Transitions->IndexStorage != nullptr);
+  REQUIRE(buildGraphAndFindPaths(Transitions, "B", Conf) ==
+          ResultPaths{
+              "(B, B getB(A), {A}), (A, A getA(), {})",
+              "(B, B getB(), {})",
+          });
+}
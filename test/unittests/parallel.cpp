@@ -0,0 +1,101 @@
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/reverse.hpp>
+
+#include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me_tests.hpp"
+#include "support/testcase_generation.hpp"
+
+namespace {
+void requireSameResults(const std::string_view Code,
+                      const std::string_view QueriedType) {
+  const auto SequentialConf = std::make_shared<Config>();
+  const auto ParallelConf = std::make_shared<Config>(Config{
+      .EnableParallelGraphBuilding = true, .EnableParallelPathFinding = true});
+  const auto [AST, Transitions] = collectTransitions(Code, SequentialConf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+
+  const auto Sequential = runGraphBuilding(Transitions, Query, SequentialConf);
+  const auto Parallel = runGraphBuilding(Transitions, Query, ParallelConf);
+  REQUIRE(Sequential.VertexData == Parallel.VertexData);
+  REQUIRE(Sequential.VertexDepth == Parallel.VertexDepth);
+  REQUIRE(Sequential.Edges == Parallel.Edges);
+  REQUIRE((runPathFinding(Sequential) | ranges::to_vector) ==
+          (runPathFinding(Parallel) | ranges::to_vector));
+
+  REQUIRE(buildGraphAndFindPaths(Transitions, QueriedType, SequentialConf) ==
+          buildGraphAndFindPaths(Transitions, QueriedType, ParallelConf));
+}
+
+// the searches of the prefixes find the paths of the sequential search in
+// the same order, independent of how far the search is split
+void requireSplitSearchFindsAllPaths(const std::string_view Code,
+                                     const std::string_view QueriedType) {
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+  const auto Sequential = runPathFinding(Data) | ranges::to_vector;
+
+  ranges::for_each(
+      std::array{size_t{1U}, size_t{4U}, size_t{1000U}},
+      [&Data, &Sequential](const size_t MinNumPrefixes) {
+        auto Paths = PathContainer{Data};
+        const auto InsertPathsOf = [&Data, &Paths](const PathType &Prefix) {
+          if (Data.RootVertices.test(Source(Prefix.back()))) {
+            Paths.insert(Prefix | ranges::views::reverse | ranges::to_vector);
+            return;
+          }
+          ranges::for_each(toLazyRange(PathGenerator{Data, Prefix}),
+                           [&Paths](PathType Path) {
+                             Paths.insert(std::move(Path));
+                           });
+        };
+        const auto Prefixes = splitPathSearch(Data, MinNumPrefixes);
+        // split until there are enough prefixes or none can be split further
+        REQUIRE((Prefixes.size() >= MinNumPrefixes ||
+                 ranges::all_of(Prefixes, [&Data](const PathType &Prefix) {
+                   return Data.RootVertices.test(Source(Prefix.back()));
+                 })));
+        ranges::for_each(Prefixes, InsertPathsOf);
+        REQUIRE((Paths | ranges::to_vector) == Sequential);
+      });
+}
+} // namespace
+
+TEST_CASE("parallel graph building and path finding") {
+  requireSameResults(AlternativePathsCode, AlternativePathsQueriedType);
+  forEachGenerated(GenerateForkingPath, 6U, requireSameResults);
+  forEachGenerated(GenerateMultiForkingPath, 6U, requireSameResults);
+}
+
+TEST_CASE("split path search") {
+  // the paths fork several times below each start edge
+  requireSplitSearchFindsAllPaths(R"(
+    struct A {};
+    struct B {};
+    struct C {};
+    struct D {};
+    D getD(C);
+    C getC(A);
+    C getC(B);
+    A getA();
+    A makeA(B);
+    B getB();
+  )",
+                                  "D");
+
+  forEachGenerated(GenerateMultiForkingPath, 5U,
+                   requireSplitSearchFindsAllPaths);
+}
@@ -0,0 +1,99 @@
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include <boost/container/flat_set.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/ranked_path_finding.hpp"
+#include "get_me_tests.hpp"
+#include "support/testcase_generation.hpp"
+
+namespace {
+// more than the paths of any of the tested graphs
+constexpr auto MaxRankedPaths = size_t{1000U};
+
+using SignatureSet = boost::container::flat_set<PathSignature>;
+
+[[nodiscard]] SignatureSet getSignatures(const GraphData &Data) {
+  return runPathFinding(Data) |
+         ranges::views::transform([&Data](const PathType &Path) {
+           return getPathSignature(Path, Data);
+         }) |
+         ranges::to<SignatureSet>;
+}
+
+[[nodiscard]] SignatureSet getRankedSignatures(const GraphData &Data) {
+  return runTopKPathFinding(Data, MaxRankedPaths) |
+         ranges::views::transform([&Data](const PathType &Path) {
+           return getPathSignature(Path, Data);
+         }) |
+         ranges::to<SignatureSet>;
+}
+
+// every path found without the reduction has a permutation that is found
+// with the reduction, and the reduction never yields a path that is not found
+// without it
+void requireSamePathsWithReduction(const std::string_view Code,
+                                   const std::string_view QueriedType,
+                                   Config BaseConf = {}) {
+  const auto Conf = std::make_shared<Config>(BaseConf);
+  BaseConf.EnablePathOrderReduction = true;
+  const auto ReducedConf = std::make_shared<Config>(BaseConf);
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+  const auto ReducedData = runGraphBuilding(Transitions, Query, ReducedConf);
+  REQUIRE(getSignatures(Data) == getSignatures(ReducedData));
+  REQUIRE(getRankedSignatures(Data) == getRankedSignatures(ReducedData));
+}
+} // namespace
+
+TEST_CASE("path order reduction") {
+  const auto RequireSamePaths = [](const std::string_view Code,
+                                   const std::string_view QueriedType) {
+    requireSamePathsWithReduction(Code, QueriedType);
+  };
+  RequireSamePaths(AlternativePathsCode, AlternativePathsQueriedType);
+  forEachGenerated(GenerateForkingPath, 5U, RequireSamePaths);
+  forEachGenerated(GenerateMultiForkingPath, 5U, RequireSamePaths);
+
+  // getA2 and getA1 commute at {A1, A2}, but the swapped order passes through
+  // {A2, R}, which the only path with these transitions already visited:
+  // {Q} -> {A2, R} -> {A1, A2} -> {A1} -> {R} -> {}. The same holds for getR
+  // and getA2, whose swapped order passes through {R}. The canonical order
+  // follows the order of the types, which follows their declaration order,
+  // both orders are tested.
+  const auto CommutingOnCycle = Config{.MaxPathLength = 5U};
+  requireSamePathsWithReduction(R"(
+    struct A1 {};
+    struct A2 {};
+    struct R {};
+    struct Q {};
+    A1 getA1(R);
+    A2 getA2();
+    R getR(A1);
+    R makeR();
+    Q getQ(A2, R);
+  )",
+                                "Q", CommutingOnCycle);
+  requireSamePathsWithReduction(R"(
+    struct R {};
+    struct A2 {};
+    struct A1 {};
+    struct Q {};
+    A1 getA1(R);
+    A2 getA2();
+    R getR(A1);
+    R makeR();
+    Q getQ(A2, R);
+  )",
+                                "Q", CommutingOnCycle);
+}
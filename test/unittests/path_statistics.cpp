@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+
+#include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/path_statistics.hpp"
+#include "get_me/query.hpp"
+#include "get_me_tests.hpp"
+#include "support/testcase_generation.hpp"
+
+namespace {
+// the counts are the number of paths runPathFinding finds
+void requireCountsOfFoundPaths(const std::string_view Code,
+                               const std::string_view QueriedType) {
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+
+  const auto Statistics = getPathStatistics(Data);
+  REQUIRE(Statistics.PathCounts.size() == Conf->MaxPathLength + 1U);
+  REQUIRE(Statistics.ExpandedPathCounts.size() == Conf->MaxPathLength + 1U);
+
+  auto PathCounts = std::vector<size_t>(Statistics.PathCounts.size());
+  auto ExpandedPathCounts = std::vector<size_t>(Statistics.PathCounts.size());
+  ranges::for_each(runPathFinding(Data), [&](const PathType &Path) {
+    ++PathCounts[Path.size()];
+    ExpandedPathCounts[Path.size()] += expandAndFlattenPath(Path, Data).size();
+  });
+  REQUIRE(PathCounts == Statistics.PathCounts);
+  REQUIRE(ExpandedPathCounts == Statistics.ExpandedPathCounts);
+}
+} // namespace
+
+TEST_CASE("path statistics") {
+  requireCountsOfFoundPaths(AlternativePathsCode, AlternativePathsQueriedType);
+  forEachGenerated(GenerateForkingPath, 5U, requireCountsOfFoundPaths);
+  forEachGenerated(GenerateStraightPath, 4U, requireCountsOfFoundPaths);
+}
+
+TEST_CASE("path statistics of the readme example") {
+  requireCountsOfFoundPaths(R"(
+    struct Apple {};
+    struct Kiwi {};
+    struct Berry {};
+    struct FruitSalad {};
+
+    FruitSalad makeFruitSalad(Apple, Kiwi, Berry);
+  )",
+                            "FruitSalad");
+}
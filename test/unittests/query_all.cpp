@@ -0,0 +1,126 @@
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/adjacent_find.hpp>
+#include <range/v3/algorithm/binary_search.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/algorithm/is_permutation.hpp>
+#include <range/v3/algorithm/is_sorted.hpp>
+#include <range/v3/iterator/operations.hpp>
+
+#include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/query_all.hpp"
+#include "get_me/ranked_path_finding.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me_tests.hpp"
+#include "support/testcase_generation.hpp"
+
+namespace {
+void requireSharedExpansionsMatch(const std::string_view Code) {
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+
+  const auto Queries = getAllQueries(*Transitions);
+  REQUIRE(ranges::is_sorted(Queries));
+  REQUIRE(ranges::adjacent_find(Queries) == Queries.end());
+  ranges::for_each(Transitions->Data, [&](const auto &Transition) {
+    REQUIRE(ranges::binary_search(
+        Queries, getQueriedTypesForType(*Transitions, ToAcquired(Transition))));
+  });
+
+  const auto Cache = std::make_shared<ExpansionCache>(Transitions);
+  ranges::for_each(Queries, [&](const TypeSet &Query) {
+    const auto Data = runGraphBuilding(Transitions, Query, Conf);
+    const auto SharedData = runGraphBuilding(Transitions, Query, Conf, Cache);
+    REQUIRE(Data.VertexData == SharedData.VertexData);
+    REQUIRE(Data.VertexDepth == SharedData.VertexDepth);
+    REQUIRE(Data.Edges == SharedData.Edges);
+    REQUIRE(Data.EdgeTransitions == SharedData.EdgeTransitions);
+  });
+}
+} // namespace
+
+TEST_CASE("query all") {
+  requireSharedExpansionsMatch(AlternativePathsCode);
+  forEachGenerated(GenerateMultiForkingPath, 4U,
+                   [](const std::string_view Code,
+                      const std::string_view /*QueriedType*/) {
+                     requireSharedExpansionsMatch(Code);
+                   });
+}
+
+TEST_CASE("query all scheduling and budgets") {
+  const auto [QueriedType, Code] = GenerateMultiForkingPath(3U);
+  const auto [AST, Transitions] = collectTransitions(Code);
+
+  const auto Scheduled = getScheduledQueries(*Transitions);
+  REQUIRE(ranges::is_permutation(Scheduled, getAllQueries(*Transitions)));
+  REQUIRE(ranges::is_sorted(estimateQueryCosts(*Transitions, Scheduled),
+                            std::greater<>{}));
+
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+  REQUIRE_FALSE(runQuery(Transitions, Query, std::make_shared<Config>())
+                    .Truncated);
+
+  // no vertex besides the vertices of the query and the empty vertex
+  const auto Report = runQuery(Transitions, Query,
+                               std::make_shared<Config>(
+                                   Config{.MaxGraphVertices = 0U}));
+  REQUIRE(Report.Truncated);
+  REQUIRE(Report.VertexCount == Query.size() + 1U);
+}
+
+TEST_CASE("query all deadline") {
+  const auto [QueriedType, Code] = GenerateMultiForkingPath(3U);
+  const auto [AST, Transitions] = collectTransitions(Code);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+
+  // the deadline has passed before the first step, no phase does any work
+  const auto Report =
+      runQuery(Transitions, Query,
+               std::make_shared<Config>(Config{.MaxQueryMilliseconds = 0U}));
+  REQUIRE(Report.Truncated);
+  REQUIRE(Report.VertexCount == Query.size() + 1U);
+  REQUIRE(Report.PathCount == 0U);
+  REQUIRE(Report.Paths.empty());
+
+  const auto Data = runGraphBuilding(Transitions, Query,
+                                     std::make_shared<Config>());
+  REQUIRE_FALSE(runTopKPathFinding(Data, 1U).empty());
+  REQUIRE(runTopKPathFinding(Data, 1U, std::chrono::steady_clock::now())
+              .empty());
+
+  // the path search stops before it takes its first edge, without a path
+  REQUIRE(ranges::distance(generatePaths(Data)) != 0);
+  REQUIRE(ranges::distance(
+              generatePaths(Data, std::chrono::steady_clock::now())) == 0);
+}
+
+TEST_CASE("query options") {
+  const auto [QueriedType, Code] = GenerateMultiForkingPath(3U);
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+
+  // the generated paths are counted like the ones of runPathFinding
+  const auto Data = runGraphBuilding(Transitions, Query, Conf);
+  const auto Report = runQuery(Transitions, Query, Conf);
+  REQUIRE(Report.PathCount == runPathFinding(Data).size());
+  REQUIRE_FALSE(Report.Paths.empty());
+
+  const auto Unranked =
+      runQuery(Transitions, Query, Conf, {}, QueryOptions{.RankPaths = false});
+  REQUIRE(Unranked.PathCount == Report.PathCount);
+  REQUIRE(Unranked.Paths.empty());
+
+  const auto Uncounted =
+      runQuery(Transitions, Query, Conf, {}, QueryOptions{.CountPaths = false});
+  REQUIRE(Uncounted.PathCount == 0U);
+  REQUIRE(Uncounted.Paths == Report.Paths);
+}
@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <llvm/Support/raw_ostream.h>
+#include <range/v3/algorithm/count.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/query_all.hpp"
+#include "get_me/query_report.hpp"
+#include "get_me_tests.hpp"
+
+TEST_CASE("query report") {
+  const auto Report = QueryReport{
+      .Query = {"A"},
+      .Paths = {R"((A, A getA("x"), {}))"},
+      .PathCount = 2U,
+      .VertexCount = 3U,
+      .EdgeCount = 4U,
+      .Truncated = true,
+      .GraphBuildingTime = std::chrono::microseconds{5},
+      .PathFindingTime = std::chrono::microseconds{6},
+      .RankingTime = std::chrono::microseconds{7},
+  };
+
+  REQUIRE(toJsonLine(Report) ==
+          R"({"query":["A"],"path_count":2,"vertices":3,"edges":4,)"
+          R"("truncated":true,)"
+          R"("timings_us":{"graph_building":5,"path_finding":6,"ranking":7},)"
+          R"("paths":["(A, A getA(\"x\"), {})"]})");
+
+  // size, 7 integers, 2 lists with one string each
+  const auto Record = toBinaryRecord(Report);
+  REQUIRE(Record.size() == 8U + (7U * 8U) + (2U * 8U) + (8U + 1U) +
+                               (8U + Report.Paths.front().size()));
+}
+
+TEST_CASE("query all report") {
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct A {};
+    struct B { explicit B(A); };
+    struct C { C(A, B); };
+    B getB(float);
+    A getA();
+  )",
+                                                     Conf);
+
+  auto Output = std::string{};
+  auto Stream = llvm::raw_string_ostream{Output};
+  auto Writer = QueryReportWriter{Stream, QueryReportFormat::JsonLines};
+  queryAll(Transitions, Conf, &Writer);
+  Stream.flush();
+
+  REQUIRE(Writer.size() == getAllQueries(*Transitions).size());
+  REQUIRE(static_cast<size_t>(ranges::count(Output, '\n')) == Writer.size());
+}
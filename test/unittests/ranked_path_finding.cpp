@@ -0,0 +1,91 @@
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/action/sort.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/take.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include "get_me/backwards_path_finding.hpp"
+#include "get_me/config.hpp"
+#include "get_me/graph.hpp"
+#include "get_me/query.hpp"
+#include "get_me/ranked_path_finding.hpp"
+#include "get_me_tests.hpp"
+#include "support/testcase_generation.hpp"
+
+namespace {
+// the ranking of a path: its length and the number of types remaining at its
+// end
+template <typename RangeType>
+[[nodiscard]] std::vector<std::pair<size_t, size_t>>
+getRanks(const GraphData &Data, const RangeType &Paths) {
+  return Paths | ranges::views::transform([&Data](const PathType &Path) {
+           return std::pair{Path.size(),
+                            Data.VertexData[Target(Path.back())].size()};
+         }) |
+         ranges::to_vector;
+}
+
+void requireTopKOfAllPaths(const std::string_view Code,
+                           const std::string_view QueriedType,
+                           const size_t MaxPathCount, Config BaseConf = {}) {
+  const auto Conf = std::make_shared<Config>(std::move(BaseConf));
+  const auto [AST, Transitions] = collectTransitions(Code, Conf);
+  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+  auto Data = runGraphBuilding(Transitions, Query, Conf);
+
+  const auto AllRanks = getRanks(Data, runPathFinding(Data)) |
+                        ranges::actions::sort |
+                        ranges::views::take(
+                            static_cast<std::ptrdiff_t>(MaxPathCount)) |
+                        ranges::to_vector;
+  REQUIRE(getRanks(Data, runTopKPathFinding(Data, MaxPathCount)) == AllRanks);
+}
+} // namespace
+
+TEST_CASE("top-k path finding") {
+  ranges::for_each(std::array{size_t{0U}, size_t{1U}, size_t{3U},
+                              size_t{100U}},
+                   [](const size_t MaxPathCount) {
+                     requireTopKOfAllPaths(AlternativePathsCode,
+                                           AlternativePathsQueriedType,
+                                           MaxPathCount);
+                   });
+
+  forEachGenerated(GenerateForkingPath, 5U,
+                   [](const std::string_view Code,
+                      const std::string_view QueriedType) {
+                     requireTopKOfAllPaths(Code, QueriedType, 10U);
+                   });
+}
+
+TEST_CASE("top-k path finding of long paths") {
+  // short paths through makeA next to long ones through the chain of getters,
+  // the ranking of the best-first search matches the one of all paths
+  constexpr auto Code = R"(
+    struct A {};
+    struct B {};
+    struct C {};
+    struct D {};
+    struct E {};
+    struct F {};
+    A getA(B);
+    B getB(C);
+    C getC(D);
+    D getD(E);
+    E getE(F);
+    A makeA(E);
+    E makeE();
+  )";
+  const auto LongConf = Config{.MaxGraphDepth = 8U, .MaxPathLength = 8U};
+  requireTopKOfAllPaths(Code, "A", 1U, LongConf);
+  requireTopKOfAllPaths(Code, "A", 2U, LongConf);
+  requireTopKOfAllPaths(Code, "A", 10U, LongConf);
+}
@@ -0,0 +1,279 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/JSON.h>
+#include <range/v3/algorithm/copy.hpp>
+#include <range/v3/algorithm/count.hpp>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "get_me/config.hpp"
+#include "get_me_tests.hpp"
+#include "server/server.hpp"
+
+namespace {
+[[nodiscard]] llvm::json::Value getResponse(QueryServer &Server,
+                                            const std::string_view Request) {
+  const auto Line = Server.handleRequest(Request);
+  REQUIRE(Line.has_value());
+  auto Response = llvm::json::parse(*Line);
+  REQUIRE(static_cast<bool>(Response));
+  REQUIRE(Response->getAsObject() != nullptr);
+  return std::move(*Response);
+}
+
+[[nodiscard]] std::int64_t getErrorCode(QueryServer &Server,
+                                        const std::string_view Request) {
+  const auto Response = getResponse(Server, Request);
+  REQUIRE(Response.getAsObject()->get("result") == nullptr);
+  const auto *const Error = Response.getAsObject()->getObject("error");
+  REQUIRE(Error != nullptr);
+  REQUIRE(Error->getString("message").has_value());
+  return Error->getInteger("code").value_or(0);
+}
+
+[[nodiscard]] LoadedTransitions
+loadTransitions(const std::shared_ptr<Config> &Conf) {
+  auto [AST, Transitions] = collectTransitions(R"(
+    struct A {};
+    struct B {};
+    struct C {};
+    A getA();
+    B getB(A);
+    C getC(A);
+  )",
+                                               Conf);
+  auto Loaded = LoadedTransitions{};
+  Loaded.ASTs.push_back(std::move(AST));
+  Loaded.Transitions = std::move(Transitions);
+  return Loaded;
+}
+
+// connects to the server at SocketPath, which may not listen yet
+[[nodiscard]] int connectTo(const std::filesystem::path &SocketPath) {
+  auto Address = sockaddr_un{};
+  Address.sun_family = AF_UNIX;
+  ranges::copy(SocketPath.native(), static_cast<char *>(Address.sun_path));
+  const auto Client = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  REQUIRE(Client != -1);
+  auto NumAttempts = size_t{0U};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  while (::connect(Client, reinterpret_cast<const sockaddr *>(&Address),
+                   sizeof(Address)) != 0) {
+    REQUIRE(++NumAttempts < 500U);
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  return Client;
+}
+
+void sendAll(const int Socket, std::string_view Data) {
+  while (!Data.empty()) {
+    const auto NumSent =
+        ::send(Socket, Data.data(), Data.size(), MSG_NOSIGNAL);
+    REQUIRE(NumSent > 0);
+    Data.remove_prefix(static_cast<size_t>(NumSent));
+  }
+}
+
+// receives until NumLines complete lines were received
+[[nodiscard]] std::string receiveLines(const int Socket,
+                                       const size_t NumLines) {
+  auto Received = std::string{};
+  auto Buffer = std::array<char, 4096>{};
+  while (ranges::count(Received, '\n') <
+         static_cast<std::ptrdiff_t>(NumLines)) {
+    const auto NumReceived = ::recv(Socket, Buffer.data(), Buffer.size(), 0);
+    REQUIRE(NumReceived > 0);
+    Received.append(Buffer.data(), static_cast<size_t>(NumReceived));
+  }
+  return Received;
+}
+
+// the received bytes until the peer closed the connection
+[[nodiscard]] std::string receiveAll(const int Socket) {
+  auto Received = std::string{};
+  auto Buffer = std::array<char, 4096>{};
+  auto NumReceived = ::recv(Socket, Buffer.data(), Buffer.size(), 0);
+  while (NumReceived > 0) {
+    Received.append(Buffer.data(), static_cast<size_t>(NumReceived));
+    NumReceived = ::recv(Socket, Buffer.data(), Buffer.size(), 0);
+  }
+  return Received;
+}
+} // namespace
+
+TEST_CASE("query server") {
+  const auto Conf = std::make_shared<Config>();
+  auto NumLoads = size_t{0U};
+  auto Server = QueryServer{Conf, [&Conf, &NumLoads]() {
+                              ++NumLoads;
+                              return loadTransitions(Conf);
+                            }};
+  REQUIRE(NumLoads == 1U);
+
+  SECTION("query") {
+    const auto Response = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":1,"method":"query",)"
+                R"("params":{"types":["B"]}})");
+    REQUIRE(Response.getAsObject()->getInteger("id") == 1);
+    const auto *const Result = Response.getAsObject()->getObject("result");
+    REQUIRE(Result != nullptr);
+    REQUIRE(Result->getArray("query")->size() == 1U);
+    REQUIRE_FALSE(Result->getArray("paths")->empty());
+    REQUIRE(Result->getBoolean("truncated") == false);
+    // the paths are only counted on request
+    REQUIRE(Result->get("path_count") == nullptr);
+  }
+
+  SECTION("counted query") {
+    const auto Response = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":1,"method":"query",)"
+                R"("params":{"types":["B"],"count_paths":true}})");
+    const auto *const Result = Response.getAsObject()->getObject("result");
+    REQUIRE(Result != nullptr);
+    REQUIRE(Result->getInteger("path_count") > 0);
+  }
+
+  SECTION("multi-type query") {
+    const auto Response = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":"a","method":"query",)"
+                R"("params":{"types":["B, C"]}})");
+    REQUIRE(Response.getAsObject()->getString("id") == "a");
+    const auto *const Result = Response.getAsObject()->getObject("result");
+    REQUIRE(Result != nullptr);
+    REQUIRE(Result->getArray("query")->size() == 2U);
+
+    // every name is split on its own
+    const auto Separate = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":"b","method":"query",)"
+                R"("params":{"types":["B", "C"]}})");
+    const auto *const SeparateResult =
+        Separate.getAsObject()->getObject("result");
+    REQUIRE(SeparateResult != nullptr);
+    REQUIRE(SeparateResult->getArray("query")->size() == 2U);
+  }
+
+  SECTION("multi-query") {
+    const auto Response = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":2,"method":"multi-query",)"
+                R"("params":{"queries":[["A"],["B"],["C"]]}})");
+    const auto *const Result = Response.getAsObject()->getArray("result");
+    REQUIRE(Result != nullptr);
+    REQUIRE(Result->size() == 3U);
+  }
+
+  SECTION("stats and reload") {
+    const auto Stats = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":3,"method":"stats"})");
+    const auto *const StatsResult = Stats.getAsObject()->getObject("result");
+    REQUIRE(StatsResult != nullptr);
+    REQUIRE(StatsResult->getInteger("transitions") > 0);
+    REQUIRE(StatsResult->getInteger("requests") == 1);
+    REQUIRE(StatsResult->getInteger("reloads") == 0);
+
+    const auto Reload = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":4,"method":"reload"})");
+    REQUIRE(Reload.getAsObject()->getObject("result") != nullptr);
+    REQUIRE(NumLoads == 2U);
+
+    const auto ReloadedStats = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":5,"method":"stats"})");
+    REQUIRE(ReloadedStats.getAsObject()->getObject("result")->getInteger(
+                "reloads") == 1);
+  }
+
+  SECTION("notifications") {
+    REQUIRE_FALSE(
+        Server.handleRequest(R"({"jsonrpc":"2.0","method":"stats"})")
+            .has_value());
+    // errors of notifications are not reported either
+    REQUIRE_FALSE(
+        Server.handleRequest(R"({"jsonrpc":"2.0","method":"unknown"})")
+            .has_value());
+    const auto Stats = getResponse(
+        Server, R"({"jsonrpc":"2.0","id":null,"method":"stats"})");
+    REQUIRE(Stats.getAsObject()->getObject("result")->getInteger(
+                "requests") == 3);
+  }
+
+  SECTION("errors") {
+    REQUIRE(getErrorCode(Server, "{") == -32700);
+    REQUIRE(getErrorCode(Server, "[]") == -32600);
+    REQUIRE(getErrorCode(Server, R"({"id":6,"method":"stats"})") == -32600);
+    REQUIRE(getErrorCode(Server,
+                         R"({"jsonrpc":"1.0","id":6,"method":"stats"})") ==
+            -32600);
+    REQUIRE(getErrorCode(Server, R"({"jsonrpc":"2.0","id":6})") == -32600);
+    REQUIRE(getErrorCode(Server,
+                         R"({"jsonrpc":"2.0","id":7,"method":"unknown"})") ==
+            -32601);
+    REQUIRE(getErrorCode(Server,
+                         R"({"jsonrpc":"2.0","id":8,"method":"query"})") ==
+            -32602);
+    REQUIRE(getErrorCode(Server, R"({"jsonrpc":"2.0","id":9,"method":"query",)"
+                                 R"("params":{"types":[1]}})") == -32602);
+    REQUIRE(getErrorCode(Server,
+                         R"({"jsonrpc":"2.0","id":9,"method":"query",)"
+                         R"("params":{"types":["B"],"count_paths":1}})") ==
+            -32602);
+    // unknown type names are reported with suggestions by the query
+    REQUIRE(getErrorCode(Server, R"({"jsonrpc":"2.0","id":10,"method":"query",)"
+                                 R"("params":{"types":["D"]}})") == -32000);
+  }
+}
+
+TEST_CASE("query server shutdown") {
+  const auto Conf = std::make_shared<Config>();
+  auto SocketPath = llvm::SmallString<128>{};
+  llvm::sys::fs::createUniquePath("get_me_server-%%%%%%.sock", SocketPath,
+                                  true);
+  const auto RemoveSocket = llvm::FileRemover{SocketPath};
+  const auto SocketFile = std::filesystem::path{SocketPath.str().str()};
+
+  auto Server = std::make_unique<QueryServer>(
+      Conf, [&Conf]() { return loadTransitions(Conf); });
+  auto Serving =
+      std::thread{[&Server, &SocketFile]() { Server->serve(SocketFile); }};
+
+  const auto Client = connectTo(SocketFile);
+  sendAll(Client, R"({"jsonrpc":"2.0","id":1,"method":"stats"})"
+                  "\n");
+  REQUIRE_FALSE(receiveLines(Client, 1U).empty());
+
+  // a line longer than the limit is rejected without buffering it, the
+  // following requests are still handled
+  sendAll(Client, std::string(QueryServer::MaxRequestLength + 1U, ' '));
+  sendAll(Client, " \n"
+                  R"({"jsonrpc":"2.0","id":2,"method":"stats"})"
+                  "\n");
+  const auto Responses = receiveLines(Client, 2U);
+  const auto FirstEnd = Responses.find('\n');
+  const auto Rejected =
+      llvm::json::parse(std::string_view{Responses}.substr(0U, FirstEnd));
+  REQUIRE(static_cast<bool>(Rejected));
+  REQUIRE(Rejected->getAsObject()->getObject("error")->getInteger("code") ==
+          -32600);
+  const auto Handled = llvm::json::parse(std::string_view{Responses}.substr(
+      FirstEnd + 1U, Responses.size() - FirstEnd - 2U));
+  REQUIRE(static_cast<bool>(Handled));
+  REQUIRE(Handled->getAsObject()->getInteger("id") == 2);
+
+  // the destructor stops serve and the open connection of the client
+  Server.reset();
+  Serving.join();
+  REQUIRE(receiveAll(Client).empty());
+  ::close(Client);
+}
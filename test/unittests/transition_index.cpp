@@ -0,0 +1,123 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/raw_ostream.h>
+#include <range/v3/algorithm/for_each.hpp>
+
+#include "get_me/config.hpp"
+#include "get_me/transition_index.hpp"
+#include "get_me_tests.hpp"
+#include "support/get_me_exception.hpp"
+
+namespace {
+[[nodiscard]] std::string
+makeIndex(const std::string_view Magic,
+          const std::initializer_list<std::uint32_t> Values) {
+  auto Result = std::string{Magic};
+  ranges::for_each(Values, [&Result](const std::uint32_t Val) {
+    auto Bytes = std::array<char, sizeof(std::uint32_t)>{};
+    llvm::support::endian::write32le(Bytes.data(), Val);
+    Result.append(Bytes.data(), Bytes.size());
+  });
+  return Result;
+}
+
+// the message of the exception thrown when loading Contents as an index,
+// empty if it was loaded
+[[nodiscard]] std::string getLoadError(const std::string_view Contents) {
+  auto IndexPath = llvm::SmallString<128>{};
+  auto File = 0;
+  REQUIRE_FALSE(llvm::sys::fs::createTemporaryFile("get_me_transition_index",
+                                                   "bin", File, IndexPath));
+  const auto RemoveIndex = llvm::FileRemover{IndexPath};
+  {
+    auto Stream = llvm::raw_fd_ostream{File, /*shouldClose=*/true};
+    Stream << Contents;
+  }
+  try {
+    std::ignore =
+        loadTransitionIndex(std::filesystem::path{IndexPath.str().str()});
+  } catch (const GetMeException &Error) {
+    return Error.message();
+  }
+  return "";
+}
+} // namespace
+
+TEST_CASE("transition index roundtrip") {
+  const auto Conf = std::make_shared<Config>();
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct A {};
+    struct B { B(A); int Val; };
+    using C = B;
+    C getC(const A &, float);
+    B getB();
+  )",
+                                                     Conf);
+
+  // a unique file, concurrent test runs do not share their index
+  auto IndexPath = llvm::SmallString<128>{};
+  REQUIRE_FALSE(llvm::sys::fs::createTemporaryFile("get_me_transition_index",
+                                                   "bin", IndexPath));
+  const auto RemoveIndex = llvm::FileRemover{IndexPath};
+  const auto IndexFile = std::filesystem::path{IndexPath.str().str()};
+  saveTransitionIndex(*Transitions, IndexFile);
+  const auto LoadedTransitions = loadTransitionIndex(IndexFile);
+
+  REQUIRE(fmt::format("{}", Transitions->Data) ==
+          fmt::format("{}", LoadedTransitions->Data));
+  REQUIRE(fmt::format("{}", Transitions->ConversionMap) ==
+          fmt::format("{}", LoadedTransitions->ConversionMap));
+
+  const auto QueryBothTransitions = [&Transitions, &LoadedTransitions,
+                                     &Conf](const std::string_view Query) {
+    REQUIRE(buildGraphAndFindPaths(Transitions, Query, Conf) ==
+            buildGraphAndFindPaths(LoadedTransitions, Query, Conf));
+  };
+  QueryBothTransitions("B");
+  QueryBothTransitions("C");
+  QueryBothTransitions("arithmetic");
+}
+
+TEST_CASE("transition index rejects corrupt files") {
+  constexpr std::string_view Magic = "GETMEIDX";
+  // version, no strings, types, declarations, transitions or conversions
+  REQUIRE(getLoadError(makeIndex(Magic, {1U, 0U, 0U, 0U, 0U, 0U})).empty());
+
+  SECTION("wrong magic") {
+    REQUIRE(getLoadError(makeIndex("GETMEIDY", {1U, 0U, 0U, 0U, 0U, 0U}))
+                .contains("is not a transition index"));
+  }
+
+  SECTION("wrong version") {
+    REQUIRE(getLoadError(makeIndex(Magic, {2U, 0U, 0U, 0U, 0U, 0U}))
+                .contains("has version 2, expected 1"));
+  }
+
+  SECTION("truncated file") {
+    REQUIRE(getLoadError(makeIndex(Magic, {1U, 0U, 0U, 0U, 0U}))
+                .contains("unexpected end of file"));
+    // the count is checked against the remaining bytes before allocating
+    REQUIRE(getLoadError(makeIndex(Magic, {1U, 0xFFFFFFFFU}))
+                .contains("unexpected end of file"));
+  }
+
+  SECTION("out-of-range id") {
+    // one type whose name refers to the missing string 5
+    REQUIRE(getLoadError(makeIndex(Magic, {1U, 0U, 1U, 5U, 0U, 0U, 0U}))
+                .contains("id 5 out of range (0)"));
+  }
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <compare>
+#include <vector>
+
+#include <boost/container/flat_set.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/equal.hpp>
+#include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/range/primitives.hpp>
+#include <range/v3/view/cartesian_product.hpp>
+#include <range/v3/view/set_algorithm.hpp>
+
+#include "get_me/type_id_set.hpp"
+
+namespace {
+using ReferenceSet = boost::container::flat_set<TypeId>;
+
+[[nodiscard]] ReferenceSet toReference(const TypeIdSet &Val) {
+  return Val | ranges::to<ReferenceSet>;
+}
+} // namespace
+
+TEST_CASE("type id set") {
+  const auto Sets = std::vector<TypeIdSet>{
+      {},           {0},           {1},          {63},
+      {64},         {0, 1},        {0, 64},      {1, 63, 64},
+      {0, 1, 2, 3}, {200},         {3, 200},     {0, 127, 128},
+      {64, 65, 500}, {63, 64, 65}, {2, 64, 200},
+  };
+
+  REQUIRE(ranges::equal(TypeIdSet{3, 1, 200, 64, 1},
+                        ReferenceSet{1, 3, 64, 200}));
+  REQUIRE(TypeIdSet{3, 1, 200, 64, 1}.size() == 4U);
+  REQUIRE(TypeIdSet{3, 200}.contains(200));
+  REQUIRE(!TypeIdSet{3, 200}.contains(136));
+
+  auto Erased = TypeIdSet{3, 200};
+  REQUIRE(Erased.erase(200));
+  REQUIRE(!Erased.erase(200));
+  REQUIRE(Erased == TypeIdSet{3});
+
+  const auto MatchesReference = [](const auto &Pair) {
+    const auto &[Lhs, Rhs] = Pair;
+    const auto ReferenceLhs = toReference(Lhs);
+    const auto ReferenceRhs = toReference(Rhs);
+
+    const auto Difference = setDifference(Lhs, Rhs);
+    const auto ReferenceDifference =
+        ranges::views::set_difference(ReferenceLhs, ReferenceRhs) |
+        ranges::to<TypeIdSet>;
+    REQUIRE(ranges::equal(Difference, ReferenceDifference));
+    REQUIRE(Difference.hash() == ReferenceDifference.hash());
+
+    const auto Union = setUnion(Lhs, Rhs);
+    const auto ReferenceUnion =
+        ranges::views::set_union(ReferenceLhs, ReferenceRhs) |
+        ranges::to<TypeIdSet>;
+    REQUIRE(ranges::equal(Union, ReferenceUnion));
+    REQUIRE(Union.hash() == ReferenceUnion.hash());
+
+    REQUIRE(isSubset(Lhs, Rhs) ==
+            std::includes(ReferenceRhs.begin(), ReferenceRhs.end(),
+                          ReferenceLhs.begin(), ReferenceLhs.end()));
+    REQUIRE(intersects(Lhs, Rhs) ==
+            !ranges::empty(ranges::views::set_intersection(ReferenceLhs,
+                                                           ReferenceRhs)));
+    REQUIRE((Lhs <=> Rhs) ==
+            std::lexicographical_compare_three_way(
+                ReferenceLhs.begin(), ReferenceLhs.end(),
+                ReferenceRhs.begin(), ReferenceRhs.end()));
+  };
+  ranges::for_each(ranges::views::cartesian_product(Sets, Sets),
+                   MatchesReference);
+}
@@ -0,0 +1,50 @@
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/algorithm/contains.hpp>
+#include <range/v3/algorithm/is_sorted.hpp>
+
+#include "get_me/query.hpp"
+#include "get_me/transitions.hpp"
+#include "get_me/type_name_index.hpp"
+#include "get_me_tests.hpp"
+
+TEST_CASE("type name index") {
+  const auto [AST, Transitions] = collectTransitions(R"(
+    struct LongName {};
+    struct LongerName {};
+    using Alias = LongName;
+    LongName getLongName();
+    LongerName getLongerName(Alias);
+  )");
+  const auto &Index = Transitions->NameIndex;
+
+  REQUIRE(Index.find("LongName").has_value());
+  REQUIRE(Index.find("Alias").has_value());
+  REQUIRE_FALSE(Index.find("Missing").has_value());
+  REQUIRE_FALSE(Index.find("Long").has_value());
+
+  // the typedef resolves to the conversions of the aliased type
+  REQUIRE(getQueriedTypesForInput(*Transitions, "Alias") ==
+          getQueriedTypesForInput(*Transitions, "LongName"));
+  REQUIRE_THROWS(getQueriedTypesForInput(*Transitions, "Missing"));
+
+  const auto Prefixed = Index.findPrefixMatches("Long", 10U);
+  REQUIRE(ranges::is_sorted(Prefixed));
+  REQUIRE(ranges::all_of(Prefixed, [](const std::string &Name) {
+    return Name.starts_with("Long");
+  }));
+  REQUIRE(ranges::contains(Prefixed, "LongName"));
+  REQUIRE(ranges::contains(Prefixed, "LongerName"));
+  REQUIRE(Index.findPrefixMatches("Long", 1U).size() == 1U);
+
+  const auto Partial = Index.findPartialMatches("gerNa", 10U);
+  REQUIRE(ranges::all_of(Partial, [](const std::string &Name) {
+    return Name.contains("gerNa");
+  }));
+  REQUIRE(ranges::contains(Partial, "LongerName"));
+  REQUIRE_FALSE(ranges::contains(Partial, "LongName"));
+  REQUIRE(Index.findPartialMatches("xyz", 10U).empty());
+}
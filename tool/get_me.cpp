@@ -1,9 +1,8 @@
-#include <algorithm>
-#include <compare>
 #include <cstddef>
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
@@ -21,17 +20,13 @@
 #include <llvm/Support/Error.h>
 #include <llvm/Support/Signals.h>
 #include <llvm/Support/raw_ostream.h>
-#include <range/v3/action/sort.hpp>
 #include <range/v3/algorithm/for_each.hpp>
-#include <range/v3/algorithm/partial_sort.hpp>
 #include <range/v3/functional/bind_back.hpp>
-#include <range/v3/functional/comparisons.hpp>
 #include <range/v3/functional/compose.hpp>
-#include <range/v3/range/access.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/range/primitives.hpp>
-#include <range/v3/view/chunk_by.hpp>
 #include <range/v3/view/enumerate.hpp>
+#include <range/v3/view/filter.hpp>
 #include <range/v3/view/for_each.hpp>
 #include <range/v3/view/take.hpp>
 #include <range/v3/view/transform.hpp>
@@ -43,19 +38,28 @@
 #include "get_me/backwards_path_finding.hpp"
 #include "get_me/config.hpp"
 #include "get_me/graph.hpp"
+#include "get_me/path_statistics.hpp"
 #include "get_me/query.hpp"
 #include "get_me/query_all.hpp"
+#include "get_me/query_report.hpp"
+#include "get_me/ranked_path_finding.hpp"
 #include "get_me/tooling.hpp"
+#include "get_me/transition_index.hpp"
 #include "get_me/transitions.hpp"
+#include "server/server.hpp"
 #include "support/get_me_exception.hpp"
+#include "support/ranges/functional.hpp"
 #include "tui/tui.hpp"
 
 // NOLINTBEGIN
 using namespace llvm::cl;
 
 static OptionCategory ToolCategory("get-me");
-const static opt<std::string> TypeName("t", desc("Name of the type to get"),
-                                       ValueRequired, cat(ToolCategory));
+const static list<std::string>
+    TypeNames("t",
+              desc("Name of the type to get, repeat the option or separate "
+                   "the names by commas to get several types at once"),
+              ValueRequired, cat(ToolCategory));
 const static opt<std::string> ConfigPath("config", desc("Config file path"),
                                          ValueRequired, cat(ToolCategory));
 const static opt<bool> Verbose("v", desc("Verbose output"), cat(ToolCategory));
@@ -65,6 +69,45 @@ const static opt<bool>
     QueryAll("query-all",
              desc("Query every type available (that has a transition)"),
              cat(ToolCategory));
+const static opt<std::string>
+    ReportPath("report",
+               desc("Write the result of every query of --query-all into a "
+                    "report file"),
+               ValueRequired, cat(ToolCategory));
+const static opt<QueryReportFormat> ReportFormat(
+    "report-format", desc("Format of the --report file"),
+    values(clEnumValN(QueryReportFormat::JsonLines, "jsonl",
+                      "One JSON object per line (default)"),
+           clEnumValN(QueryReportFormat::Binary, "binary",
+                      "Compact binary records")),
+    init(QueryReportFormat::JsonLines), cat(ToolCategory));
+
+const static opt<std::string>
+    SaveIndex("save-index",
+              desc("Save the collected transitions into an index file"),
+              ValueRequired, cat(ToolCategory));
+const static opt<std::string>
+    LoadIndex("load-index",
+              desc("Load the transitions from an index file instead of "
+                   "parsing the sources"),
+              ValueRequired, cat(ToolCategory));
+
+const static opt<std::string>
+    ServeSocket("serve",
+                desc("Keep the transitions loaded and answer queries on a "
+                     "Unix domain socket at the given path"),
+                ValueRequired, cat(ToolCategory));
+
+const static opt<bool>
+    PathStats("path-stats",
+              desc("Only print the number of paths per path length, "
+                   "without ranking or printing the paths"),
+              cat(ToolCategory));
+const static opt<bool>
+    Unranked("unranked",
+             desc("Print the paths in the order they are found instead of "
+                  "ranking them, the first paths are printed immediately"),
+             cat(ToolCategory));
 
 const static opt<bool> DumpConfig("dump-config",
                                   desc("Dump the current configuration"),
@@ -102,13 +145,15 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
-  GetMeException::verify(ranges::size(Sources) == 1,
-                         "Built {} ASTs, expected 1", ranges::size(Sources));
-
-  clang::tooling::ClangTool Tool(OptionsParser->getCompilations(), Sources);
+  const auto &Compilations = OptionsParser->getCompilations();
+  // without explicit sources, every file of the compilation database is used
+  const auto SourceFiles =
+      ranges::empty(Sources) ? Compilations.getAllFiles() : Sources;
 
+  auto ArgumentsAdjuster = getParseArgumentsAdjuster(Conf);
   if (Verbose) {
-    Tool.appendArgumentsAdjuster(
+    ArgumentsAdjuster = clang::tooling::combineAdjusters(
+        ArgumentsAdjuster,
         [](const clang::tooling::CommandLineArguments &Args,
            const llvm::StringRef /*Filename*/) {
           auto Res = Args;
@@ -118,76 +163,125 @@ int main(int argc, const char **argv) {
   }
 
   if (Interactive) {
+    clang::tooling::ClangTool Tool(Compilations, SourceFiles);
+    Tool.appendArgumentsAdjuster(ArgumentsAdjuster);
     runTui(Conf, Tool);
     return 0;
   }
 
-  std::vector<std::unique_ptr<clang::ASTUnit>> ASTs{};
-  const auto BuildASTsResult = Tool.buildASTs(ASTs);
-  GetMeException::verify(BuildASTsResult == 0, "Error building ASTs");
+  const auto LoadTransitions = [&Compilations, &SourceFiles,
+                                &ArgumentsAdjuster, &Conf]() {
+    auto Loaded = LoadedTransitions{};
+    if (!LoadIndex.getValue().empty()) {
+      Loaded.Transitions = loadTransitionIndex(LoadIndex.getValue());
+      spdlog::info("Loaded {} transitions from {}",
+                   Loaded.Transitions->getNumTransitions(),
+                   LoadIndex.getValue());
+      return Loaded;
+    }
+    GetMeException::verify(!ranges::empty(SourceFiles),
+                           "No source files to build ASTs for");
+    Loaded.Transitions =
+        collectTransitions(Compilations, SourceFiles, Conf, ArgumentsAdjuster);
+    spdlog::info("Collected {} transitions from {} sources",
+                 Loaded.Transitions->getNumTransitions(), SourceFiles.size());
+    return Loaded;
+  };
+
+  if (!ServeSocket.getValue().empty()) {
+    auto Server = QueryServer{Conf, LoadTransitions};
+    Server.serve(ServeSocket.getValue());
+    return 0;
+  }
+
+  const auto Transitions = LoadTransitions().Transitions;
 
-  auto Transitions = collectTransitions(*ASTs.front(), Conf);
+  if (!SaveIndex.getValue().empty()) {
+    saveTransitionIndex(*Transitions, SaveIndex.getValue());
+    spdlog::info("Saved {} transitions to {}", Transitions->getNumTransitions(),
+                 SaveIndex.getValue());
+    if (TypeNames.empty() && !QueryAll) {
+      return 0;
+    }
+  }
 
   if (QueryAll) {
-    queryAll(Transitions, Conf);
+    if (ReportPath.getValue().empty()) {
+      queryAll(Transitions, Conf);
+      return 0;
+    }
+    auto ErrorCode = std::error_code{};
+    auto ReportFile = llvm::raw_fd_ostream{ReportPath.getValue(), ErrorCode};
+    GetMeException::verify(!ErrorCode, "could not open {} for writing: {}",
+                           ReportPath.getValue(), ErrorCode.message());
+    auto Writer = QueryReportWriter{ReportFile, ReportFormat.getValue()};
+    queryAll(Transitions, Conf, &Writer);
+    spdlog::info("Wrote {} query reports to {}", Writer.size(),
+                 ReportPath.getValue());
     return 0;
   }
 
-  const auto &QueriedType = TypeName.getValue();
-  const auto Query = getQueriedTypesForInput(*Transitions, QueriedType);
+  // the names of all -t options, split at their top-level commas
+  const auto QueriedTypes =
+      splitTypeNames(fmt::format("{}", fmt::join(TypeNames, ",")));
+  const auto Queries = getQueriedTypesForInputs(*Transitions, QueriedTypes);
 
-  auto Data = runGraphBuilding(Transitions, Query, Conf);
+  auto Data = runGraphBuilding(Transitions, Queries, Conf);
   {
     auto DotFile = fmt::output_file("graph.dot");
     DotFile.print("{:d}", Data);
   }
-  auto Paths = runPathFinding(Data) | ranges::to_vector |
-               ranges::actions::sort(ranges::less{}, ranges::size);
-
-  spdlog::info("|Transitions|: {}", ranges::size(Data.Transitions->FlatData));
-  spdlog::info("Graph size: |V| = {}, |E| = {}", Data.VertexData.size(),
-               Data.Edges.size());
-
-  spdlog::info(
-      "path length distribution: {}",
-      Paths |
-          ranges::views::chunk_by([](const PathType &Lhs, const PathType &Rhs) {
-            return Lhs.size() == Rhs.size();
-          }) |
-          ranges::views::transform([](const auto Range) {
-            return std::pair{ranges::size(Range), ranges::begin(Range)->size()};
-          }));
-  spdlog::info("generated {} paths", Paths.size());
-
-  const auto OutputPathCount =
-      std::min<size_t>(Paths.size(), Conf->MaxPathOutputCount);
-  ranges::partial_sort(
-      Paths,
-      Paths.begin() +
-          static_cast<std::vector<PathType>::difference_type>(OutputPathCount),
-      [&Data](const PathType &Lhs, const PathType &Rhs) {
-        if (const auto Comp = Lhs.size() <=> Rhs.size(); std::is_neq(Comp)) {
-          return std::is_lt(Comp);
-        }
-        if (Lhs.empty()) {
-          return true;
-        }
-        return Data.VertexData[Target(Lhs.back())].size() <
-               Data.VertexData[Target(Rhs.back())].size();
-      });
-
-  ranges::for_each(
-      Paths |
-          ranges::views::for_each(
-              ranges::bind_back(expandAndFlattenPath, Data)) |
-          ranges::views::enumerate | ranges::views::take(OutputPathCount),
-      [&Data](const auto IndexedPath) {
-        const auto &[Number, Path] = IndexedPath;
-        spdlog::info(
-            "path #{}: {} -> remaining: {}", Number,
-            fmt::join(Path | ranges::views::transform(ranges::compose(
-                                 ToTransition, &FlatPathEdge::FlatTransition)),
-                      ", "),
-            Data.VertexData[Target(Path.back().Edge)]);
-      });
+  spdlog::info("|Transitions|: {}", Data.Transitions->getNumTransitions());
+  spdlog::info("Graph size: |V| = {}, |E| = {} (parallel edges bundled)",
+               Data.VertexData.size(), Data.Edges.size());
+
+  // (path length, number of paths) for every length that has paths
+  const auto ToDistribution = [](const std::vector<size_t> &Counts) {
+    return ranges::views::enumerate(Counts) |
+           ranges::views::filter([](const auto IndexedCount) {
+             return Value(IndexedCount) != 0U;
+           }) |
+           ranges::views::transform([](const auto IndexedCount) {
+             return std::pair{Index(IndexedCount), Value(IndexedCount)};
+           }) |
+           ranges::to_vector;
+  };
+  // counted by the search of runPathFinding, without storing the paths
+  const auto Statistics = getPathStatistics(Data);
+  spdlog::info("path length distribution: {}",
+               ToDistribution(Statistics.PathCounts));
+  spdlog::info("expanded path length distribution: {}",
+               ToDistribution(Statistics.ExpandedPathCounts));
+  if (PathStats) {
+    return 0;
+  }
+
+  const auto PrintFlatPaths = [&Data, &Conf](auto &&Paths) {
+    ranges::for_each(
+        std::forward<decltype(Paths)>(Paths) |
+            ranges::views::for_each(
+                ranges::bind_back(generateFlatPaths, Data)) |
+            ranges::views::enumerate |
+            ranges::views::take(Conf->MaxPathOutputCount),
+        [&Data](const auto IndexedPath) {
+          const auto &[Number, Path] = IndexedPath;
+          spdlog::info("path #{}: {} -> remaining: {}", Number,
+                       fmt::join(Path | ranges::views::transform(
+                                            ranges::compose(
+                                                ToTransition,
+                                                &FlatPathEdge::FlatTransition)),
+                                 ", "),
+                       Data.VertexData[Target(Path.back().Edge)]);
+        });
+  };
+
+  if (Unranked) {
+    // the search stops after the paths that are printed
+    PrintFlatPaths(generatePaths(Data));
+    return 0;
+  }
+
+  const auto Paths = runTopKPathFinding(Data, Conf->MaxPathOutputCount);
+  spdlog::info("found {} paths", Paths.size());
+  PrintFlatPaths(Paths);
 }